@@ -32,6 +32,7 @@ SOURCES +=                                      \
         sim-window.cpp                          \
 	sim-screen.cpp                          \
 	sim-rpl.cpp                             \
+	sim-sampler.cpp                         \
 	dmcp.cpp                                \
         ../fonts/EditorFont.cc                  \
         ../fonts/HelpFont.cc                    \
@@ -40,12 +41,14 @@ SOURCES +=                                      \
         ../src/algebraic.cc                     \
         ../src/arithmetic.cc                    \
         ../src/array.cc                         \
+        ../src/benchmark.cc                     \
         ../src/bignum.cc                        \
         ../src/catalog.cc                       \
         ../src/characters.cc                    \
         ../src/command.cc                       \
         ../src/comment.cc                       \
         ../src/compare.cc                       \
+        ../src/compiled.cc                      \
         ../src/complex.cc                       \
         ../src/conditionals.cc                  \
         ../src/constants.cc                     \
@@ -76,6 +79,7 @@ SOURCES +=                                      \
         ../src/object.cc                        \
         ../src/plot.cc                          \
         ../src/polynomial.cc                    \
+        ../src/profiler.cc                      \
         ../src/program.cc                       \
         ../src/renderer.cc                      \
         ../src/runtime.cc                       \
@@ -95,7 +99,8 @@ SOURCES +=                                      \
 HEADERS +=                                      \
 	sim-window.h                            \
 	sim-screen.h                            \
-	sim-rpl.h
+	sim-rpl.h                               \
+	sim-sampler.h
 
 
 # User interface forms
@@ -121,6 +126,9 @@ color:DEFINES += CONFIG_COLOR
 # Additional external library HIDAPI linked statically into the code
 INCLUDEPATH += ../src/dm42 ../src/dmcp ../src
 
+# Export symbols so that the sampling profiler can name functions
+unix:    QMAKE_LFLAGS += -rdynamic
+
 win32:   LIBS += -lsetupapi
 android: LIBS +=
 freebsd: LIBS += -lthr -liconv
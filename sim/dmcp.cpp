@@ -36,12 +36,17 @@
 #include "tests.h"
 #include "types.h"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <iostream>
+#include <mutex>
 #include <stdarg.h>
 #include <stdio.h>
 #include <sys/select.h>
 #include <sys/stat.h>
 #include <sys/time.h>
+#include <thread>
 
 
 #pragma GCC diagnostic ignored "-Wunused-parameter"
@@ -264,6 +269,8 @@ int handle_menu(const smenu_t * menu_id, int action, int cur_line)
     return 0;
 }
 
+static void wakeup_rpl();
+
 volatile int8_t  keys[4] = { 0 };
 volatile uint    keyrd   = 0;
 volatile uint    keywr   = 0;
@@ -334,6 +341,7 @@ int key_push(int k)
     else
         record(keys_warning, "Dropped key %d (wr %u rd %u)", k, keywr, keyrd);
     record(keys, "Pushed key %d (wr %u rd %u)", k, keywr, keyrd);
+    wakeup_rpl();
     return keywr - keyrd < nkeys;
 }
 
@@ -837,10 +845,37 @@ int sys_free_mem()
     return 1024 * 1024;
 }
 
-void sys_delay(uint32_t ms_delay)
-{
-    ui_ms_sleep(ms_delay);
-}
+// ============================================================================
+//
+//   Virtual clock
+//
+// ============================================================================
+//   In virtual clock mode, time does not pass while the calculator waits for
+//   a key. A delay from the RPL thread, e.g. in the Wait command, completes
+//   immediately. A delay from another thread, e.g. the tests waiting for the
+//   calculator, lets virtual time pass in steps:
+//   - While the RPL thread is idle with no pending key or test command,
+//     the clock jumps to the next timer deadline, and the delay waits for
+//     the RPL thread to handle that timer, e.g. a long press or key repeat.
+//   - While the RPL thread is busy, virtual time does not pass. Delays use
+//     real time, counted in a separate budget, so that timeouts and
+//     interrupt keys still work with programs that run forever.
+//   - While the RPL thread waits for a timer but cannot go idle, e.g. in
+//     the Wait command with a pending test command, virtual time passes
+//     each time it goes to sleep.
+//   Other threads see the virtual time plus that budget, the RPL thread
+//   only sees the virtual time.
+//   The idle RPL thread blocks until a key, a test command or a timer
+//   deadline wakes it up.
+
+bool                           virtual_clock = false;
+static std::atomic<uint32_t>   virtual_ms(0);
+static std::atomic<uint32_t>   busy_ms(0);
+static std::atomic<bool>       rpl_idle(false);
+static std::atomic<uint>       rpl_sleeps(0);
+static thread_local bool       rpl_thread = false;
+static std::mutex              clock_mutex;
+static std::condition_variable clock_wakeup;
 
 static struct timer
 {
@@ -848,20 +883,123 @@ static struct timer
     bool     enabled;
 } timers[4];
 
+
+static uint32_t real_current_ms()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (tv.tv_sec * 1000000 + tv.tv_usec) / 1000;
+}
+
+
+static void wakeup_rpl()
+{
+    if (virtual_clock)
+    {
+        std::lock_guard<std::mutex> lock(clock_mutex);
+        clock_wakeup.notify_all();
+    }
+}
+
+
+static bool timer_expired(uint32_t since)
+{
+    uint32_t now = sys_current_ms();
+    for (int i = 0; i < 4; i++)
+        if (timers[i].enabled &&
+            int(timers[i].deadline - now) < 0 &&
+            int(timers[i].deadline - since) >= 0)
+            return true;
+    return false;
+}
+
+
+void sys_delay(uint32_t ms_delay)
+{
+    if (!virtual_clock)
+    {
+        ui_ms_sleep(ms_delay);
+        return;
+    }
+    if (rpl_thread)
+    {
+        virtual_ms += ms_delay;
+        std::this_thread::yield();
+        return;
+    }
+
+    // A polling loop with no delay must still let time pass, e.g. for the
+    // Wait command to complete while the tests wait for a test command
+    if (!ms_delay)
+        ms_delay = 1;
+
+    std::unique_lock<std::mutex> lock(clock_mutex);
+    clock_wakeup.notify_all();          // Let RPL thread see test commands
+    while (ms_delay)
+    {
+        if (rpl_idle && key_empty() && !test_command)
+        {
+            // Stop right after the next timer deadline, if there is one
+            uint32_t now  = virtual_ms;
+            uint32_t step = ms_delay;
+            for (int i = 0; i < 4; i++)
+            {
+                uint32_t left = timers[i].deadline - now;
+                if (timers[i].enabled && int(left) >= 0 && left < step)
+                    step = left + 1;
+            }
+            virtual_ms += step;
+            ms_delay -= step;
+
+            // Wait for the RPL thread to process the timer and go idle again
+            uint sleeps = rpl_sleeps;
+            clock_wakeup.notify_all();
+            if (ms_delay)
+                clock_wakeup.wait_for(lock, std::chrono::milliseconds(100),
+                                      [&]() { return rpl_sleeps != sleeps; });
+        }
+        else
+        {
+            // If the RPL thread goes to sleep meanwhile, it is waiting for
+            // a timer, e.g. in Wait with a pending test command
+            uint sleeps  = rpl_sleeps;
+            bool waiting = clock_wakeup.wait_for(
+                lock, std::chrono::milliseconds(1),
+                [&]() { return rpl_sleeps != sleeps; });
+            if (waiting)
+                virtual_ms++;
+            else
+                busy_ms++;
+            ms_delay--;
+        }
+    }
+}
+
+
+void virtual_clock_rpl_thread()
+{
+    rpl_thread = true;
+}
+
+
 void sys_sleep()
 {
     uint32_t entry = sys_current_ms();
-    while (!test_command && key_empty())
+    if (virtual_clock)
     {
-        uint32_t now = sys_current_ms();
-        for (int i = 0; i < 4; i++)
-            if (timers[i].enabled &&
-                int(timers[i].deadline - now) < 0 &&
-                int(timers[i].deadline - entry) >= 0)
-                goto done;
-        ui_ms_sleep(tests::running ? 1 : 20);
+        std::unique_lock<std::mutex> lock(clock_mutex);
+        rpl_idle = true;
+        rpl_sleeps++;
+        clock_wakeup.notify_all();
+        while (!test_command && key_empty() && !timer_expired(entry))
+            clock_wakeup.wait_for(lock, std::chrono::milliseconds(20));
+        rpl_idle = false;
+    }
+    else
+    {
+        while (!test_command && key_empty() && !timer_expired(entry))
+            ui_ms_sleep(tests::running ? 1 : 20);
     }
-done:
     CLR_ST(STAT_SUSPENDED | STAT_OFF | STAT_PGM_END);
 }
 
@@ -966,9 +1104,21 @@ int sys_disk_write_enable(int val)
 
 uint32_t sys_current_ms()
 {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return (tv.tv_sec * 1000000 + tv.tv_usec) / 1000;
+    if (virtual_clock)
+    {
+        // Start from the real time, so that Ticks looks plausible
+        static bool started = false;
+        if (!started)
+        {
+            uint32_t zero = 0;
+            virtual_ms.compare_exchange_strong(zero, real_current_ms());
+            started = true;
+        }
+        if (rpl_thread)
+            return virtual_ms;
+        return virtual_ms + busy_ms;
+    }
+    return real_current_ms();
 }
 
 
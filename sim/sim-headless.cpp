@@ -0,0 +1,672 @@
+// ****************************************************************************
+//  sim-headless.cpp                                              DB48X project
+// ****************************************************************************
+//
+//   File Description:
+//
+//     A simulator without a user interface, for tests and benchmarks
+//
+//     This replaces the Qt main window, screen and RPL thread with plain
+//     C++ threads, so that the test suite and library benchmarks can run
+//     on machines without Qt or a display, e.g. in continuous integration.
+//     The LCD is still drawn in memory, but nothing is shown, and image
+//     comparisons are skipped since they require Qt to read PNG files.
+//
+// ****************************************************************************
+//   (C) 2024 Christophe de Dinechin <christophe@dinechin.org>
+//   This software is licensed under the terms outlined in LICENSE.txt
+// ****************************************************************************
+//   This file is part of DB48X.
+//
+//   DB48X is free software: you can redistribute it and/or modify
+//   it under the terms outlined in the LICENSE.txt file
+//
+//   DB48X is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include "dmcp.h"
+#include "main.h"
+#include "object.h"
+#include "recorder.h"
+#include "sim-dmcp.h"
+#include "sim-sampler.h"
+#include "sysmenu.h"
+#include "target.h"
+#include "tests.h"
+#include "version.h"
+
+#include <atomic>
+#include <chrono>
+#include <dirent.h>
+#include <ftw.h>
+#include <langinfo.h>
+#include <locale.h>
+#include <map>
+#include <mutex>
+#include <new>
+#include <string>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+RECORDER(options,  32, "Information about command line options");
+RECORDER(headless, 16, "Headless simulator");
+RECORDER_TWEAK_DEFINE(rpl_objects_detail, 0, "Set to 1 to see object addresses")
+
+bool run_tests = false;
+bool noisy_tests = false;
+uint memory_size = 100;           // Memory size in kilobytes
+
+
+size_t recorder_render_object(intptr_t tracing,
+                              const char *UNUSED /* format */,
+                              char *buffer, size_t size,
+                              uintptr_t arg)
+// ----------------------------------------------------------------------------
+//   Render a value during a recorder dump (%t format)
+// ----------------------------------------------------------------------------
+{
+    object_p value = object_p(arg);
+    size_t result = 0;
+    if (tracing)
+    {
+        if (value)
+        {
+            char tmp[80];
+            size_t sz =  value->render(tmp, sizeof(tmp)-1);
+            if (sz >= sizeof(tmp))
+                sz = sizeof(tmp)-1;
+            tmp[sz] = 0;
+            if (RECORDER_TWEAK(rpl_objects_detail))
+                result = snprintf(buffer, size, "%p[%lu] %s[%s]",
+                                  (void *) value,
+                                  value->size(),
+                                  value->fancy(),
+                                  tmp);
+            else
+                result = snprintf(buffer, size, "%s", tmp);
+
+        }
+        else
+        {
+            result = snprintf(buffer, size, "0x0 <NULL>");
+        }
+    }
+    else
+    {
+        result = snprintf(buffer, size, "%p", (void *) value);
+    }
+    return result;
+}
+
+
+
+// ============================================================================
+//
+//   Platform support without a user interface
+//
+// ============================================================================
+
+static std::atomic<uint>                  refresh_count(0);
+static std::map<std::string, std::string> settings;
+static std::mutex                         settings_lock;
+
+
+void ui_refresh()
+// ----------------------------------------------------------------------------
+//   Count refreshes, which the tests use to know the calculator is ready
+// ----------------------------------------------------------------------------
+{
+    refresh_count++;
+    record(headless, "Refresh count=%u", uint(refresh_count));
+}
+
+
+uint ui_refresh_count()
+// ----------------------------------------------------------------------------
+//   Return the number of times the display was actually udpated
+// ----------------------------------------------------------------------------
+{
+    return refresh_count;
+}
+
+
+void ui_screenshot()
+// ----------------------------------------------------------------------------
+//   No screenshots without a screen
+// ----------------------------------------------------------------------------
+{
+}
+
+
+void ui_push_key(int UNUSED k)
+// ----------------------------------------------------------------------------
+//   No key highlight to update
+// ----------------------------------------------------------------------------
+{
+}
+
+
+void ui_ms_sleep(uint ms_delay)
+// ----------------------------------------------------------------------------
+//   Suspend the current thread for the given interval in milliseconds
+// ----------------------------------------------------------------------------
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms_delay));
+}
+
+
+int ui_file_selector(const char  *UNUSED title,
+                     const char  *UNUSED base_dir,
+                     const char  *UNUSED ext,
+                     file_sel_fn UNUSED callback,
+                     void        *UNUSED data,
+                     int          UNUSED disp_new,
+                     int          UNUSED overwrite_check)
+// ----------------------------------------------------------------------------
+//  There is nobody to select a file interactively
+// ----------------------------------------------------------------------------
+{
+    return 0;
+}
+
+
+void ui_save_setting(const char *name, const char *value)
+// ----------------------------------------------------------------------------
+//  Keep settings in memory, so that each run starts from the same state
+// ----------------------------------------------------------------------------
+{
+    std::lock_guard<std::mutex> lock(settings_lock);
+    settings[name] = value;
+}
+
+
+size_t ui_read_setting(const char *name, char *value, size_t maxlen)
+// ----------------------------------------------------------------------------
+//  Read a setting saved during this run
+// ----------------------------------------------------------------------------
+{
+    std::lock_guard<std::mutex> lock(settings_lock);
+    auto found = settings.find(name);
+    if (found == settings.end())
+        return 0;
+    size_t len = found->second.length();
+    if (maxlen)
+    {
+        size_t copy = len < maxlen - 1 ? len : maxlen - 1;
+        memcpy(value, found->second.c_str(), copy);
+        value[copy] = 0;
+    }
+    return len;
+}
+
+
+uint ui_battery()
+// ----------------------------------------------------------------------------
+//   Always report a full battery, so that the display does not change
+// ----------------------------------------------------------------------------
+{
+    return 1000;
+}
+
+
+bool ui_charging()
+// ----------------------------------------------------------------------------
+//   Always on USB power
+// ----------------------------------------------------------------------------
+{
+    return true;
+}
+
+
+void ui_start_buzzer(uint UNUSED frequency)
+// ----------------------------------------------------------------------------
+//   No sound
+// ----------------------------------------------------------------------------
+{
+}
+
+
+void ui_stop_buzzer()
+// ----------------------------------------------------------------------------
+//   No sound
+// ----------------------------------------------------------------------------
+{
+}
+
+
+int ui_wrap_io(file_sel_fn callback, const char *path, void *data, bool)
+// ----------------------------------------------------------------------------
+//   No user interface thread to synchronize with, call directly
+// ----------------------------------------------------------------------------
+{
+    cstring name = path;
+    for (cstring p = path; *p; p++)
+        if (*p == '/' || *p == '\\')
+            name = p + 1;
+    return callback(path, name, data);
+}
+
+
+void ui_load_keymap(cstring UNUSED name)
+// ----------------------------------------------------------------------------
+//   No keyboard to display
+// ----------------------------------------------------------------------------
+{
+}
+
+
+bool tests::image_match(cstring file, int x, int y, int w, int h, bool force)
+// ----------------------------------------------------------------------------
+//   Reading reference images requires Qt, so image checks always pass
+// ----------------------------------------------------------------------------
+{
+    record(headless, "Skipping image %+s at (%d,%d) size %dx%d%+s",
+           file, x, y, w, h, force ? " (forced)" : "");
+    return true;
+}
+
+
+
+// ============================================================================
+//
+//   Main entry point
+//
+// ============================================================================
+
+#if DEBUG
+// Ensure linker keeps debug code
+extern cstring debug();
+#endif // DEBUG
+
+
+static void usage(cstring name)
+// ----------------------------------------------------------------------------
+//   Show the options specific to the headless simulator
+// ----------------------------------------------------------------------------
+{
+    fprintf(stderr,
+            "Usage: %s [options] [files]\n"
+            "  -T[test]     Run the test suite, or only the given tests\n"
+            "  -V           Virtual clock, time only passes when busy\n"
+            "  -P<file>     Write folded stacks from a sampling profiler\n"
+            "  -j<jobs>     Run test categories in parallel processes\n"
+            "               (-j0 uses one process per core)\n"
+            "  -b<ms>       Time allowed for each file to run\n"
+            "  -B<iter>     Run the benchmark suite, print CSV to stdout\n"
+            "  -t<traces>   Activate recorder traces\n"
+            "  -m<kb>       Memory size in kilobytes\n"
+            "Files, e.g. library/CollatzBenchmark.48s, are evaluated "
+            "in order after the tests,\n"
+            "and must be in the current directory or below it\n",
+            name);
+}
+
+
+static int next_category(void *arg)
+// ----------------------------------------------------------------------------
+//   Pick the next category that no worker has started yet
+// ----------------------------------------------------------------------------
+{
+    std::atomic<uint> *next = (std::atomic<uint> *) arg;
+    return (*next)++;
+}
+
+
+static bool make_worker_directory(std::string &dir)
+// ----------------------------------------------------------------------------
+//   Create a private directory for a worker, mirroring the current one
+// ----------------------------------------------------------------------------
+//   Everything in the current directory, like help/ or config/, is linked
+//   from the worker directory, except data/, where the tests write files.
+{
+    char *cwd = getcwd(nullptr, 0);
+    if (!cwd)
+        return false;
+    cstring tmp = getenv("TMPDIR");
+    dir = std::string(tmp && *tmp ? tmp : "/tmp") + "/db48x-worker-XXXXXX";
+    DIR *d = mkdtemp(&dir[0]) ? opendir(cwd) : nullptr;
+    if (!d)
+    {
+        free(cwd);
+        return false;
+    }
+    while (struct dirent *e = readdir(d))
+    {
+        std::string name = e->d_name;
+        if (name == "." || name == ".." || name == "data")
+            continue;
+        std::string target = std::string(cwd) + "/" + name;
+        std::string link   = dir + "/" + name;
+        if (symlink(target.c_str(), link.c_str()) < 0)
+            perror(link.c_str());
+    }
+    closedir(d);
+    free(cwd);
+    return true;
+}
+
+
+static int remove_entry(const char *path, const struct stat *, int, FTW *)
+// ----------------------------------------------------------------------------
+//   Remove one entry of a worker directory, without following links
+// ----------------------------------------------------------------------------
+{
+    return remove(path);
+}
+
+
+static void remove_worker_directory(const std::string &dir)
+// ----------------------------------------------------------------------------
+//   Remove a worker directory and the files the tests wrote in it
+// ----------------------------------------------------------------------------
+{
+    if (nftw(dir.c_str(), remove_entry, 16, FTW_DEPTH | FTW_PHYS) < 0)
+        perror(dir.c_str());
+}
+
+
+static uint run_parallel_tests(uint jobs)
+// ----------------------------------------------------------------------------
+//   Run the test categories in worker processes, and merge their results
+// ----------------------------------------------------------------------------
+//   Each worker is a separate process, so it has its own runtime, settings
+//   and saved state. Workers take categories from a shared counter as they
+//   become idle, so that a long category does not hold back the others.
+//   The output of each worker is kept in a temporary file and shown as a
+//   block once it is done, so that lines from different workers do not mix.
+//   Each worker runs in its own directory, so that the files written by the
+//   tests of one worker do not clash with those of another.
+{
+    void *shared = mmap(nullptr, sizeof(std::atomic<uint>),
+                        PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED)
+    {
+        perror("Unable to share test counter");
+        return 1;
+    }
+    std::atomic<uint> *next = new(shared) std::atomic<uint>(0);
+
+    struct worker
+    {
+        pid_t       pid;
+        FILE       *output;
+        FILE       *results;
+        std::string dir;
+    };
+    std::vector<worker> workers;
+
+    // When workers share cores, commands take longer to complete
+    uint cores = std::thread::hardware_concurrency();
+    if (cores && jobs > cores)
+        tests::default_wait_time *= (jobs + cores - 1) / cores;
+
+    fprintf(stderr, "Running %u test categories in %u processes\n",
+            tests::num_categories, jobs);
+    fflush(stderr);
+    for (uint j = 0; j < jobs; j++)
+    {
+        worker w = { 0, tmpfile(), tmpfile(), "" };
+        if (!w.output || !w.results || !make_worker_directory(w.dir))
+        {
+            perror("Unable to create worker files");
+            if (w.output)
+                fclose(w.output);
+            if (w.results)
+                fclose(w.results);
+            break;
+        }
+        w.pid = fork();
+        if (w.pid < 0)
+        {
+            perror("Unable to start worker");
+            fclose(w.output);
+            fclose(w.results);
+            remove_worker_directory(w.dir);
+            break;
+        }
+        if (w.pid == 0)
+        {
+            dup2(fileno(w.output), 2);
+            if (chdir(w.dir.c_str()) < 0)
+            {
+                perror(w.dir.c_str());
+                _exit(1);
+            }
+            std::thread rpl([]()
+            {
+                virtual_clock_rpl_thread();
+                program_main();
+            });
+            ui_ms_sleep(1000);
+            tests worker;
+            worker.run_categories(next_category, next);
+            worker.export_results(w.results);
+            fflush(stderr);
+            _exit(0);           // Do not wait for the RPL thread
+        }
+        workers.push_back(w);
+    }
+
+    tests merged;
+    uint  lost = 0;
+    for (auto &w : workers)
+    {
+        int status = 0;
+        waitpid(w.pid, &status, 0);
+
+        char   buffer[4096];
+        size_t size;
+        rewind(w.output);
+        while ((size = fread(buffer, 1, sizeof(buffer), w.output)))
+            fwrite(buffer, 1, size, stderr);
+
+        rewind(w.results);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) ||
+            !merged.import_results(w.results))
+        {
+            fprintf(stderr, "Worker %d failed with status %d\n",
+                    int(w.pid), status);
+            lost++;
+        }
+        fclose(w.output);
+        fclose(w.results);
+        remove_worker_directory(w.dir);
+    }
+    munmap(shared, sizeof(std::atomic<uint>));
+
+    merged.summary();
+    if (lost)
+        fprintf(stderr, "%u of %u workers failed, their results are missing\n",
+                lost, uint(workers.size()));
+    return merged.failed() + lost;
+}
+
+
+static cstring option_value(int &a, int argc, char *argv[])
+// ----------------------------------------------------------------------------
+//   Option value, either as in -w500 or as in -w 500
+// ----------------------------------------------------------------------------
+{
+    if (argv[a][2])
+        return argv[a] + 2;
+    if (a + 1 < argc)
+        return argv[++a];
+    return "";
+}
+
+
+int main(int argc, char *argv[])
+// ----------------------------------------------------------------------------
+//   Main entry point for the headless simulator
+// ----------------------------------------------------------------------------
+{
+    const char *traces = getenv("DB48X_TRACES");
+    recorder_trace_set(".*(error|warn(ing)?)s?");
+    if (traces)
+        recorder_trace_set(traces);
+    recorder_dump_on_common_signals(0, 0);
+    recorder_configure_type('t', recorder_render_object);
+
+#if DEBUG
+    // This is just to link otherwise unused code intended for use in debugger
+    if (traces && traces[0] == char(0xFF))
+        if (cstring result = debug())
+            record(options, "Strange input %s", result);
+#endif // DEBUG
+
+    // QApplication does this for the Qt simulator. Without it, the C library
+    // works on bytes, and UTF-8 text does not match regular expressions.
+    // Tests expect UTF-8 even if the environment does not select it.
+    setlocale(LC_ALL, "");
+    if (strcmp(nl_langinfo(CODESET), "UTF-8") != 0)
+        setlocale(LC_CTYPE, "C.UTF-8");
+
+    fprintf(stderr, "%s version %s (headless)\n", PROGRAM_NAME, DB48X_VERSION);
+
+    std::vector<cstring> files;
+    uint                 file_timeout = 60000;
+    bool                 want_tests   = false;
+    uint                 jobs         = 1;
+    uint                 bench_iters  = 0;
+
+    record(options,
+           "Headless simulator invoked as %+s with %d arguments",
+           argv[0], argc-1);
+    for (int a = 1; a < argc; a++)
+    {
+        record(options, "  %u: %+s", a, argv[a]);
+        if (argv[a][0] != '-')
+        {
+            files.push_back(argv[a]);
+            continue;
+        }
+
+        switch(argv[a][1])
+        {
+        case 't':
+            recorder_trace_set(argv[a]+2);
+            break;
+        case 'n':
+            noisy_tests = true;
+            break;
+        case 'V':
+            virtual_clock = true;
+            break;
+        case 'P':
+            sampler_output = option_value(a, argc, argv);
+            break;
+        case 'T':
+            want_tests = true;
+            // fall-through
+        case 'O':
+            if (argv[a][2])
+            {
+                static bool first = true;
+                if (first)
+                {
+                    recorder_trace_set("est_.*=0");
+                    first = false;
+                }
+                char tname[256];
+                if (strcmp(argv[a]+2, "all") == 0)
+                    strcpy(tname, "est_.*");
+                else
+                    snprintf(tname, sizeof(tname)-1, "est_%s", argv[a]+2);
+                recorder_trace_set(tname);
+            }
+            break;
+        case 'D':
+            tests::dump_on_fail = option_value(a, argc, argv);
+            break;
+        case 'k':
+            keymap_filename = option_value(a, argc, argv);
+            break;
+        case 'w':
+            tests::default_wait_time = atoi(option_value(a, argc, argv));
+            break;
+        case 'd':
+            tests::key_delay_time = atoi(option_value(a, argc, argv));
+            break;
+        case 'r':
+            tests::refresh_delay_time = atoi(option_value(a, argc, argv));
+            break;
+        case 'i':
+            tests::image_wait_time = atoi(option_value(a, argc, argv));
+            break;
+        case 'm':
+            memory_size = atoi(option_value(a, argc, argv));
+            break;
+        case 'b':
+            file_timeout = atoi(option_value(a, argc, argv));
+            break;
+        case 'B':
+            bench_iters = atoi(option_value(a, argc, argv));
+            break;
+        case 'j':
+            jobs = atoi(option_value(a, argc, argv));
+            if (!jobs)
+                jobs = std::thread::hardware_concurrency();
+            break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (!want_tests && files.empty() && !bench_iters)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    uint failed = 0;
+    if (want_tests && jobs > 1)
+    {
+        // Fork the workers before starting any thread in this process
+        failed += run_parallel_tests(jobs);
+        want_tests = false;
+        if (files.empty() && !bench_iters)
+            return failed ? 1 : 0;
+    }
+
+    // Run the calculator on its own thread, and drive it from this one
+    std::thread rpl([]()
+    {
+        virtual_clock_rpl_thread();
+        sampler_attach();
+        program_main();
+        sampler_detach();
+    });
+    ui_ms_sleep(1000);          // In case we are loading a file
+
+    if (want_tests)
+    {
+        tests TestSuite;
+        TestSuite.run(0);
+        failed += TestSuite.failed();
+    }
+    if (!files.empty())
+    {
+        tests Files;
+        Files.run_files(files.size(), files.data(), file_timeout);
+        failed += Files.failed();
+    }
+    if (bench_iters)
+    {
+        tests Bench;
+        Bench.run_benchmark(bench_iters, file_timeout);
+        failed += Bench.failed();
+    }
+
+    // Ask the RPL thread to exit and wait for it
+    key_push(tests::EXIT_PGM);
+    rpl.join();
+
+    return failed ? 1 : 0;
+}
@@ -30,7 +30,9 @@
 #include "main.h"
 #include "object.h"
 #include "recorder.h"
+#include "sim-dmcp.h"
 #include "sim-rpl.h"
+#include "sim-sampler.h"
 #include "sim-window.h"
 #include "sysmenu.h"
 #include "version.h"
@@ -137,6 +139,15 @@ int main(int argc, char *argv[])
             case 'n':
                 noisy_tests = true;
                 break;
+            case 'V':
+                virtual_clock = true;
+                break;
+            case 'P':
+                if (argv[a][2])
+                    sampler_output = argv[a]+2;
+                else if (a + 1 < argc)
+                    sampler_output = argv[++a];
+                break;
 
             case 'T':
                 run_tests = true;
@@ -30,6 +30,8 @@
 #include "sim-rpl.h"
 
 #include "dmcp.h"
+#include "sim-dmcp.h"
+#include "sim-sampler.h"
 #include "tests.h"
 
 extern int key_remaining();
@@ -59,5 +61,8 @@ void RPLThread::run()
 //   Thread entry point
 // ----------------------------------------------------------------------------
 {
+    virtual_clock_rpl_thread();
+    sampler_attach();
     program_main();
+    sampler_detach();
 }
@@ -0,0 +1,290 @@
+// ****************************************************************************
+//  sim-sampler.cpp                                               DB48X project
+// ****************************************************************************
+//
+//   File Description:
+//
+//     Sampling profiler for the simulator
+//
+//
+//
+//
+//
+//
+//
+// ****************************************************************************
+//   (C) 2024 Christophe de Dinechin <christophe@dinechin.org>
+//   This software is licensed under the terms outlined in LICENSE.txt
+// ****************************************************************************
+//   This file is part of DB48X.
+//
+//   DB48X is free software: you can redistribute it and/or modify
+//   it under the terms outlined in the LICENSE.txt file
+//
+//   DB48X is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include "sim-sampler.h"
+
+#include "object.h"
+#include "recorder.h"
+#include "runtime.h"
+
+#include <stdio.h>
+
+RECORDER(sampler, 16, "Sampling profiler");
+RECORDER_TWEAK_DEFINE(sampling_rate, 1000, "Sampling profiler rate in Hz");
+
+const char *sampler_output = nullptr;
+
+
+#if defined(_WIN32)
+
+void sampler_attach()
+// ----------------------------------------------------------------------------
+//   No sampling profiler on Windows
+// ----------------------------------------------------------------------------
+{
+    if (sampler_output)
+        fprintf(stderr, "Sampling profiler is not available on Windows\n");
+}
+
+
+void sampler_detach()
+// ----------------------------------------------------------------------------
+//   No sampling profiler on Windows
+// ----------------------------------------------------------------------------
+{
+}
+
+#else // !_WIN32
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <string>
+#include <thread>
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+
+#if defined(__GLIBC__) || defined(__APPLE__)
+#include <execinfo.h>
+#define HAVE_BACKTRACE
+#endif
+
+
+struct sampler_data
+// ----------------------------------------------------------------------------
+//   Samples recorded by the signal handler
+// ----------------------------------------------------------------------------
+{
+    enum
+    {
+        MAX_SAMPLES = 32768,    // Stop recording when we have that many
+        MAX_RPL     = 16,       // RPL frames recorded per sample
+        MAX_NATIVE  = 48,       // Native frames recorded per sample
+        SKIP_NATIVE = 2,        // Signal handler and signal trampoline
+    };
+
+    struct sample
+    {
+        uint16_t rpl;           // Number of RPL frames
+        uint16_t native;        // Number of native frames
+        uint16_t ids[MAX_RPL];  // Type of next object, innermost first
+        void *   pcs[MAX_NATIVE];
+    };
+
+    pthread_t                   target;
+    std::thread                 thread;
+    std::atomic<bool>           running;
+    std::atomic<uint>           count;
+    sample                      samples[MAX_SAMPLES];
+};
+
+static sampler_data *Sampler = nullptr;
+
+
+static void sampler_signal(int)
+// ----------------------------------------------------------------------------
+//   Record the RPL and native stacks of the interrupted RPL thread
+// ----------------------------------------------------------------------------
+//   This must be async-signal safe: it only reads memory and writes
+//   to preallocated storage. Objects outside RPL memory are ignored.
+{
+    sampler_data *s = Sampler;
+    if (!s)
+        return;
+    uint n = s->count.load(std::memory_order_relaxed);
+    if (n >= sampler_data::MAX_SAMPLES)
+        return;
+
+    sampler_data::sample &sample = s->samples[n];
+    uint   rpl    = 0;
+    size_t frames = rt.call_depth() / 2;
+    for (size_t f = 0; f < frames && rpl < sampler_data::MAX_RPL; f++)
+    {
+        object_p obj = rt.run_stepping(f);
+        if (obj && rt.is_user_command(utf8(obj)))
+            sample.ids[rpl++] = obj->type();
+    }
+    sample.rpl = rpl;
+
+#ifdef HAVE_BACKTRACE
+    sample.native = backtrace(sample.pcs, sampler_data::MAX_NATIVE);
+#else
+    sample.native = 0;
+#endif // HAVE_BACKTRACE
+
+    s->count.store(n + 1, std::memory_order_release);
+}
+
+
+static void sampler_loop(sampler_data *s, uint rate)
+// ----------------------------------------------------------------------------
+//   Interrupt the RPL thread at the sampling rate
+// ----------------------------------------------------------------------------
+{
+    auto period = std::chrono::microseconds(1000000 / rate);
+    while (s->running.load())
+    {
+        std::this_thread::sleep_for(period);
+        pthread_kill(s->target, SIGPROF);
+    }
+}
+
+
+void sampler_attach()
+// ----------------------------------------------------------------------------
+//   Start sampling the current thread if an output file was given
+// ----------------------------------------------------------------------------
+{
+    if (!sampler_output || Sampler)
+        return;
+
+    int rate = RECORDER_TWEAK(sampling_rate);
+    if (rate <= 0 || rate > 100000)
+        rate = 1000;
+
+    Sampler = new sampler_data;
+    Sampler->target = pthread_self();
+    Sampler->count = 0;
+    Sampler->running = true;
+
+#ifdef HAVE_BACKTRACE
+    // The first call may load libraries, which is not safe in a handler
+    void *pcs[4];
+    backtrace(pcs, 4);
+#endif // HAVE_BACKTRACE
+
+    struct sigaction sa = {};
+    sa.sa_handler = sampler_signal;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGPROF, &sa, nullptr);
+
+    record(sampler, "Sampling at %d Hz into %s", rate, sampler_output);
+    Sampler->thread = std::thread(sampler_loop, Sampler, uint(rate));
+}
+
+
+static std::string sampler_native_name(void *pc)
+// ----------------------------------------------------------------------------
+//   Return the name of the function containing a native address
+// ----------------------------------------------------------------------------
+{
+    Dl_info info;
+    char    buffer[64];
+    if (dladdr(pc, &info) && info.dli_sname)
+    {
+        int   status = 0;
+        char *name = abi::__cxa_demangle(info.dli_sname, nullptr, 0, &status);
+        std::string result = status == 0 && name ? name : info.dli_sname;
+        free(name);
+
+        // Remove the arguments to merge overloads
+        size_t paren = result.find('(');
+        if (paren != std::string::npos && paren > 0)
+            result.resize(paren);
+        return result;
+    }
+    if (dladdr(pc, &info) && info.dli_fname)
+    {
+        cstring base = strrchr(info.dli_fname, '/');
+        snprintf(buffer, sizeof(buffer), "%s+%#lx",
+                 base ? base + 1 : info.dli_fname,
+                 (unsigned long) ((char *) pc - (char *) info.dli_fbase));
+        return buffer;
+    }
+    snprintf(buffer, sizeof(buffer), "%p", pc);
+    return buffer;
+}
+
+
+void sampler_detach()
+// ----------------------------------------------------------------------------
+//   Stop sampling and write the folded stacks
+// ----------------------------------------------------------------------------
+{
+    sampler_data *s = Sampler;
+    if (!s)
+        return;
+
+    s->running = false;
+    s->thread.join();
+    signal(SIGPROF, SIG_IGN);
+    Sampler = nullptr;
+
+    // Count identical stacks
+    std::map<std::string, uint>   stacks;
+    std::map<void *, std::string> names;
+    uint count = s->count.load(std::memory_order_acquire);
+    for (uint n = 0; n < count; n++)
+    {
+        sampler_data::sample &sample = s->samples[n];
+        std::string stack;
+
+        // RPL frames, outermost first
+        for (uint f = sample.rpl; f-- > 0; )
+        {
+            if (stack.size())
+                stack += ';';
+            stack += cstring(object::name(object::id(sample.ids[f])));
+        }
+
+        // Native frames, outermost first, without the signal handler
+        for (uint f = sample.native; f-- > sampler_data::SKIP_NATIVE; )
+        {
+            void *pc = sample.pcs[f];
+            auto found = names.find(pc);
+            if (found == names.end())
+                found = names.emplace(pc, sampler_native_name(pc)).first;
+            if (stack.size())
+                stack += ';';
+            stack += found->second;
+        }
+        stacks[stack]++;
+    }
+
+    if (FILE *out = fopen(sampler_output, "w"))
+    {
+        for (auto &stack : stacks)
+            fprintf(out, "%s %u\n", stack.first.c_str(), stack.second);
+        fclose(out);
+        fprintf(stderr, "Wrote %u samples (%zu stacks) to %s%s\n",
+                count, stacks.size(), sampler_output,
+                count >= sampler_data::MAX_SAMPLES ? ", buffer was full" : "");
+    }
+    else
+    {
+        fprintf(stderr, "Unable to write samples to %s\n", sampler_output);
+    }
+    delete s;
+}
+
+#endif // _WIN32
@@ -0,0 +1,42 @@
+#ifndef SIM_SAMPLER_H
+#define SIM_SAMPLER_H
+// ****************************************************************************
+//  sim-sampler.h                                                 DB48X project
+// ****************************************************************************
+//
+//   File Description:
+//
+//     Sampling profiler for the simulator
+//
+//     A sampler thread periodically interrupts the RPL thread with SIGPROF.
+//     The signal handler records the RPL call stack, using the next object
+//     in each frame, and the native call stack. When the RPL thread exits,
+//     identical stacks are counted and written in the "folded" format used
+//     by flame graph tools, one line per stack, e.g.
+//       program;FOR;DUP;program_main;...;Mul::evaluate 42
+//
+//     The sampling rate is set with the sampling_rate recorder tweak,
+//     e.g. -tsampling_rate=500 for 500 samples per second
+//
+// ****************************************************************************
+//   (C) 2024 Christophe de Dinechin <christophe@dinechin.org>
+//   This software is licensed under the terms outlined in LICENSE.txt
+// ****************************************************************************
+//   This file is part of DB48X.
+//
+//   DB48X is free software: you can redistribute it and/or modify
+//   it under the terms outlined in the LICENSE.txt file
+//
+//   DB48X is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+// File where to write the folded stacks, null if not sampling
+extern const char *sampler_output;
+
+// Called on the RPL thread when it starts and before it exits
+void sampler_attach();
+void sampler_detach();
+
+#endif // SIM_SAMPLER_H
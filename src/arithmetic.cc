@@ -123,8 +123,7 @@ algebraic_p arithmetic::non_numeric<add>(algebraic_r x, algebraic_r y)
     {
         if (list_g yl = y->as<list>())
             return xl + yl;
-        if (list_g yl = rt.make<list>(byte_p(+y), y->size()))
-            return xl + yl;
+        return xl->append(+y);
     }
     else if (list_g yl = y->as<list>())
     {
@@ -1432,11 +1431,110 @@ algebraic_p arithmetic::evaluate(id          op,
 }
 
 
+object::result arithmetic::small_integer_evaluate(id op, ops_t ops)
+// ----------------------------------------------------------------------------
+//   Fast path for common operations between two small integers
+// ----------------------------------------------------------------------------
+//   This avoids the generic type promotions and GC-protected pointers for
+//   cases such as `1 +` in loops. It returns SKIP if the generic code
+//   needs to run, e.g. on overflow into bignum, fraction results, division
+//   by zero, or when numerical results are requested
+{
+    switch(op)
+    {
+    case ID_add:
+    case ID_sub:
+    case ID_mul:
+    case ID_div:
+    case ID_mod:
+    case ID_rem:
+        break;
+    default:
+        return SKIP;
+    }
+
+    object_p x = rt.stack(1);
+    object_p y = rt.stack(0);
+    if (!x || !y)
+        return ERROR;
+
+    id     xt, yt;
+    ularge xv, yv;
+    if (!small_integer(x, xt, xv) || !small_integer(y, yt, yv))
+        return SKIP;
+    if (yv == 0 && (op == ID_div || op == ID_mod || op == ID_rem))
+        return SKIP;
+    if (Settings.NumericalResults())
+        return SKIP;
+    if (!ops.integer_ok(xt, yt, xv, yv))
+        return rt.error() ? ERROR : SKIP;
+    if (xv == 0)
+        xt = ID_integer;
+
+    integer_p result = rt.make<integer>(xt, xv);
+    if (result && rt.drop() && rt.top(result))
+        return OK;
+    return ERROR;
+}
+
+
+object::result arithmetic::append_evaluate(id op)
+// ----------------------------------------------------------------------------
+//   Fast path appending to the list or text built by a previous append
+// ----------------------------------------------------------------------------
+//   When building a list or text with `+` in a loop, the stack often holds
+//   the only reference to the previous result. Removing the arguments from
+//   the stack before appending lets text::append grow it in place instead of
+//   copying it. On error, the unchanged arguments are put back on the stack.
+{
+    if (op != ID_add || Settings.NumericalResults())
+        return SKIP;
+
+    object_p y = rt.stack(1);
+    object_p x = rt.stack(0);
+    if (!x || !y)
+        return ERROR;
+    if (!rt.growable(y))
+        return SKIP;
+
+    // List + list and text + text concatenate, list + object appends
+    id     yt   = y->type();
+    id     xt   = x->type();
+    size_t len  = x->size();
+    byte_p data = byte_p(x);
+    if (xt == yt && (xt == ID_list || xt == ID_text))
+        data = text_p(x)->value(&len);
+    else if (yt != ID_list)
+        return SKIP;
+
+    text_g   yg = text_p(y);
+    object_g xg = x;
+    gcbytes  dg = data;
+    if (!rt.drop(2))
+        return ERROR;
+    if (text_g r = text::append(yg, dg, len))
+        if (rt.push(+r))
+            return OK;
+
+    // Restore the arguments, which were not modified
+    if (rt.push(+yg))
+        rt.push(+xg);
+    return ERROR;
+}
+
+
 object::result arithmetic::evaluate(id op, ops_t ops)
 // ----------------------------------------------------------------------------
 //   Shared code for all forms of evaluation using the RPL stack
 // ----------------------------------------------------------------------------
 {
+    result fast = small_integer_evaluate(op, ops);
+    if (fast != SKIP)
+        return fast;
+    fast = append_evaluate(op);
+    if (fast != SKIP)
+        return fast;
+
     // Fetch arguments from the stack
     // Possibly wrong type, i.e. it migth not be an algebraic on the stack,
     // but since we tend to do extensive type checking later, don't overdo it
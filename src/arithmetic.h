@@ -93,6 +93,21 @@ struct arithmetic : algebraic
 
     static fraction_p fraction_promotion(algebraic_g &x);
 
+    static bool small_integer(object_p obj, id &type, ularge &value)
+    // ------------------------------------------------------------------------
+    //   Check if an object is a real integer that fits in a machine word
+    // ------------------------------------------------------------------------
+    {
+        type = obj->type();
+        if (type != ID_integer && type != ID_neg_integer)
+            return false;
+        integer_p i = integer_p(obj);
+        if (!i->native())
+            return false;
+        value = i->value<ularge>();
+        return true;
+    }
+
     // We do not insert parentheses for algebraic values
     INSERT_DECL(arithmetic);
 
@@ -123,6 +138,8 @@ protected:
     template <typename Op> static ops_t Ops();
 
     static result evaluate(id op, ops_t ops);
+    static result small_integer_evaluate(id op, ops_t ops);
+    static result append_evaluate(id op);
 
     template <typename Op> static result evaluate();
     // ------------------------------------------------------------------------
@@ -0,0 +1,341 @@
+// ****************************************************************************
+//  benchmark.cc                                                  DB48X project
+// ****************************************************************************
+//
+//   File Description:
+//
+//     Built-in benchmark suite
+//
+//
+//
+//
+//
+//
+//
+//
+// ****************************************************************************
+//   (C) 2024 Christophe de Dinechin <christophe@dinechin.org>
+//   This software is licensed under the terms outlined in LICENSE.txt
+// ****************************************************************************
+//   This file is part of DB48X.
+//
+//   DB48X is free software: you can redistribute it and/or modify
+//   it under the terms outlined in the LICENSE.txt file
+//
+//   DB48X is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include "benchmark.h"
+
+#include "files.h"
+#include "integer.h"
+#include "program.h"
+#include "renderer.h"
+#include "settings.h"
+#include "text.h"
+
+RECORDER(benchmark, 16, "Benchmarks");
+
+
+struct workload
+// ----------------------------------------------------------------------------
+//   A built-in benchmark workload
+// ----------------------------------------------------------------------------
+{
+    cstring  name;              // Name used to select the workload
+    cstring  file;              // File in the library directory, or null
+    uint16_t precision;         // Precision to run at, 0 for current
+    cstring  source;            // RPL source code if not a file
+};
+
+
+static const workload workloads[] =
+// ----------------------------------------------------------------------------
+//   Workloads selected by "All"
+// ----------------------------------------------------------------------------
+//   Each micro-benchmark loops enough to take a few milliseconds on DM42
+{
+    { "DecimalMul12",   nullptr,  12,
+      "2 √ 3 √ 1 200 START DUP2 * DROP NEXT DROP2" },
+    { "DecimalMul24",   nullptr,  24,
+      "2 √ 3 √ 1 200 START DUP2 * DROP NEXT DROP2" },
+    { "DecimalMul100",  nullptr, 100,
+      "2 √ 3 √ 1 200 START DUP2 * DROP NEXT DROP2" },
+    { "DecimalDiv12",   nullptr,  12,
+      "2 √ 3 √ 1 200 START DUP2 / DROP NEXT DROP2" },
+    { "DecimalDiv24",   nullptr,  24,
+      "2 √ 3 √ 1 200 START DUP2 / DROP NEXT DROP2" },
+    { "DecimalDiv100",  nullptr, 100,
+      "2 √ 3 √ 1 200 START DUP2 / DROP NEXT DROP2" },
+    { "DecimalExp12",   nullptr,  12,
+      "2 √ 1 50 START DUP EXP DROP NEXT DROP" },
+    { "DecimalExp24",   nullptr,  24,
+      "2 √ 1 50 START DUP EXP DROP NEXT DROP" },
+    { "DecimalExp100",  nullptr, 100,
+      "2 √ 1 20 START DUP EXP DROP NEXT DROP" },
+    { "BignumMul",      nullptr,   0,
+      "3 300 ^ 7 250 ^ 1 200 START DUP2 * DROP NEXT DROP2" },
+    { "ListSort",       nullptr,   0,
+      "1 300 FOR i i 7919 * 1009 MOD NEXT 300 →List "
+      "1 20 START DUP SORT DROP NEXT DROP" },
+    { "MatrixDet",      nullptr,   0,
+      "[[1 2 3 4][5 6 7 8.5][9 10 11.5 12][13 14.25 15 16]] "
+      "1 50 START DUP DET DROP NEXT DROP" },
+    { "PlotRedraw",     nullptr,   0,
+      "'3*sin(x)' 1 5 START DUP FunctionPlot NEXT DROP" },
+    { "GC",             nullptr,   0,
+      "1 50 START 1 100 FOR i i NEXT 100 →List DROP NEXT GC DROP" },
+    { "Collatz",        "CollatzBenchmark.48s", 0, nullptr },
+    { "Units",          "UnitsBenchmark.48s",   0, nullptr },
+    { "NQueens",        "NQueens.48s",          0, nullptr },
+};
+
+
+enum { MAX_ITERATIONS = 64 };
+
+
+static bool benchmark_run(list_g &rows, cstring name,
+                          object_r code, uint precision, uint iterations)
+// ----------------------------------------------------------------------------
+//   Run one workload, and append a row with its statistics to rows
+// ----------------------------------------------------------------------------
+{
+    uint   times[MAX_ITERATIONS];
+    size_t cycles = 0;
+    size_t bytes  = 0;
+
+    // Run at the workload's precision, restore user settings and stack on exit
+    stack_depth_restore sdr;
+    save<settings>      saved(Settings, Settings);
+    if (precision)
+        Settings.Precision(precision);
+
+    record(benchmark, "Running %+s, %u iterations", name, iterations);
+    for (uint i = 0; i <= iterations; i++)
+    {
+        size_t gccycles  = rt.gc_cycles();
+        size_t allocated = rt.allocated_bytes();
+        uint   start     = sys_current_ms();
+        if (program::run(+code) != object::OK)
+            return false;
+        uint   duration  = sys_current_ms() - start;
+        if (rt.depth() > sdr.depth)
+            rt.drop(rt.depth() - sdr.depth);
+
+        // First run is a warm-up run, e.g. to load code in the cache
+        if (i)
+        {
+            times[i - 1] = duration;
+            cycles += rt.gc_cycles() - gccycles;
+            bytes  += rt.allocated_bytes() - allocated;
+        }
+    }
+
+    // Sort the durations to get order statistics
+    for (uint i = 1; i < iterations; i++)
+        for (uint j = i; j > 0 && times[j - 1] > times[j]; j--)
+        {
+            uint t       = times[j];
+            times[j]     = times[j - 1];
+            times[j - 1] = t;
+        }
+    uint median = iterations % 2
+        ? times[iterations / 2]
+        : (times[iterations / 2 - 1] + times[iterations / 2]) / 2;
+    uint p95    = times[(iterations * 95 + 99) / 100 - 1];
+
+    text_g    tname   = text::make(name);
+    integer_g tmedian = integer::make(median);
+    integer_g tmin    = integer::make(times[0]);
+    integer_g tp95    = integer::make(p95);
+    integer_g tcycles = integer::make(cycles);
+    integer_g tbytes  = integer::make(bytes / iterations);
+    if (!tname || !tmedian || !tmin || !tp95 || !tcycles || !tbytes)
+        return false;
+    list_g row = list::make(tname, tmedian, tmin, tp95, tcycles, tbytes);
+    if (row)
+        rows = rows->append(object_p(+row));
+    return rows && row;
+}
+
+
+static bool benchmark_workload(list_g &rows, const workload &w, uint iters)
+// ----------------------------------------------------------------------------
+//   Load a built-in workload and run it
+// ----------------------------------------------------------------------------
+{
+    object_g code;
+    if (w.file)
+    {
+        files_g disk = files::make("library");
+        text_g  file = text::make(w.file);
+        if (disk && file)
+            code = disk->recall(file);
+    }
+    else
+    {
+        code = program::parse(utf8(w.source), strlen(w.source));
+    }
+    if (!code)
+    {
+        if (!rt.error())
+            rt.invalid_object_error();
+        return false;
+    }
+    return benchmark_run(rows, w.name, code, w.precision, iters);
+}
+
+
+static bool benchmark_item(list_g &rows, object_r what, uint iterations)
+// ----------------------------------------------------------------------------
+//   Run a workload given by name or as a program
+// ----------------------------------------------------------------------------
+{
+    if (text_p txt = what->as<text>())
+    {
+        size_t len  = 0;
+        utf8   name = txt->value(&len);
+        bool   all  = len == 3 && strncasecmp(cstring(name), "all", 3) == 0;
+        for (const workload &w : workloads)
+        {
+            if (all ||
+                (strlen(w.name) == len &&
+                 strncasecmp(cstring(name), w.name, len) == 0))
+            {
+                if (!benchmark_workload(rows, w, iterations))
+                    return false;
+                if (!all)
+                    return true;
+            }
+        }
+        if (all)
+            return true;
+
+        // Otherwise, use it as the name of a file in the library
+        char file[64];
+        if (len >= sizeof(file))
+        {
+            rt.invalid_file_name_error();
+            return false;
+        }
+        memcpy(file, name, len);
+        file[len] = 0;
+        workload w = { file, file, 0, nullptr };
+        return benchmark_workload(rows, w, iterations);
+    }
+
+    // Anything else is evaluated as is
+    return benchmark_run(rows, "User", what, 0, iterations);
+}
+
+
+list_p benchmark(object_p whatp, uint iterations)
+// ----------------------------------------------------------------------------
+//   Run the given workloads, return one row of statistics for each
+// ----------------------------------------------------------------------------
+//   The first row is a header with the name of each column
+{
+    if (iterations < 1 || iterations > MAX_ITERATIONS)
+    {
+        rt.value_error();
+        return nullptr;
+    }
+
+    object_g what = whatp;
+    text_g   name = text::make("Name");
+    text_g   med  = text::make("Median");
+    text_g   min  = text::make("Min");
+    text_g   p95  = text::make("P95");
+    text_g   gcs  = text::make("GCCycles");
+    text_g   sz   = text::make("Bytes");
+    if (!name || !med || !min || !p95 || !gcs || !sz)
+        return nullptr;
+    list_g   header = list::make(name, med, min, p95, gcs, sz);
+    list_g   rows   = header ? list::make(header) : nullptr;
+    if (!rows)
+        return nullptr;
+
+    if (list_p items = what->as<list>())
+    {
+        list_g workloads = items;
+        for (object_p item : *workloads)
+        {
+            object_g w = item;
+            if (!benchmark_item(rows, w, iterations))
+                return nullptr;
+        }
+    }
+    else if (!benchmark_item(rows, what, iterations))
+    {
+        return nullptr;
+    }
+    return rows;
+}
+
+
+text_p benchmark_csv(list_p rowsp)
+// ----------------------------------------------------------------------------
+//   Convert the rows generated by benchmark to CSV
+// ----------------------------------------------------------------------------
+{
+    list_g   rows = rowsp;
+    renderer r;
+    for (object_p row : *rows)
+    {
+        list_g cols = row->as<list>();
+        if (!cols)
+            continue;
+        bool first = true;
+        for (object_p col : *cols)
+        {
+            if (!first)
+                r.put(',');
+            first = false;
+            if (text_p txt = col->as<text>())
+            {
+                size_t len = 0;
+                utf8   val = txt->value(&len);
+                r.put(val, len);
+            }
+            else
+            {
+                r.printf("%llu", col->as_uint64(0, false));
+            }
+        }
+        r.put('\n');
+    }
+    return text::make(r.text(), r.size());
+}
+
+
+COMMAND_BODY(Benchmark)
+// ----------------------------------------------------------------------------
+//   Run workloads and return statistics as a list
+// ----------------------------------------------------------------------------
+{
+    uint iterations = rt.stack(0)->as_uint32(0, true);
+    if (rt.error())
+        return ERROR;
+    if (list_p rows = benchmark(rt.stack(1), iterations))
+        if (rt.drop() && rt.top(rows))
+            return OK;
+    return ERROR;
+}
+
+
+COMMAND_BODY(BenchmarkCSV)
+// ----------------------------------------------------------------------------
+//   Run workloads and return statistics as comma-separated values
+// ----------------------------------------------------------------------------
+{
+    uint iterations = rt.stack(0)->as_uint32(0, true);
+    if (rt.error())
+        return ERROR;
+    if (list_p rows = benchmark(rt.stack(1), iterations))
+        if (text_p csv = benchmark_csv(rows))
+            if (rt.drop() && rt.top(csv))
+                return OK;
+    return ERROR;
+}
@@ -0,0 +1,43 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+// ****************************************************************************
+//  benchmark.h                                                   DB48X project
+// ****************************************************************************
+//
+//   File Description:
+//
+//     Built-in benchmark suite
+//
+//     The Benchmark command runs workloads several times after a warm-up
+//     run, and reports the median, minimum and 95th percentile durations,
+//     along with the garbage collection cycles and bytes allocated.
+//     Workloads are either built-in micro-benchmarks, benchmarks from the
+//     library directory, or any program given by the user.
+//
+// ****************************************************************************
+//   (C) 2024 Christophe de Dinechin <christophe@dinechin.org>
+//   This software is licensed under the terms outlined in LICENSE.txt
+// ****************************************************************************
+//   This file is part of DB48X.
+//
+//   DB48X is free software: you can redistribute it and/or modify
+//   it under the terms outlined in the LICENSE.txt file
+//
+//   DB48X is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include "command.h"
+#include "list.h"
+
+// Run the workloads in `what` with the given number of timed iterations
+list_p benchmark(object_p what, uint iterations);
+
+// Convert the result of benchmark() to comma-separated values
+text_p benchmark_csv(list_p rows);
+
+COMMAND_DECLARE(Benchmark,2);           // Result as a list
+COMMAND_DECLARE(BenchmarkCSV,2);        // Result as CSV text
+
+#endif // BENCHMARK_H
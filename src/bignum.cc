@@ -111,6 +111,66 @@ HELP_BODY(bignum)
 }
 
 
+uint bignum::chunk_power(uint base, uint *digits)
+// ----------------------------------------------------------------------------
+//   Largest power of the base below 2^24, so that byte steps fit in 32 bits
+// ----------------------------------------------------------------------------
+{
+    uint power = base;
+    uint count = 1;
+    while (power * base < (1U << 24))
+    {
+        power *= base;
+        count++;
+    }
+    if (digits)
+        *digits = count;
+    return power;
+}
+
+
+size_t bignum::mul_add(byte *num, size_t size, size_t max, uint mul, uint add)
+// ----------------------------------------------------------------------------
+//   Compute num = num * mul + add in place, return the new size
+// ----------------------------------------------------------------------------
+//   mul and add must be below 2^24. Bytes at or above max are dropped,
+//   which computes modulo the word size for based numbers.
+{
+    uint carry = add;
+    for (size_t i = 0; i < size; i++)
+    {
+        uint t = num[i] * mul + carry;
+        num[i] = byte(t);
+        carry = t >> 8;
+    }
+    while (carry && size < max)
+    {
+        num[size++] = byte(carry);
+        carry >>= 8;
+    }
+    return size;
+}
+
+
+uint bignum::div_rem(byte *num, size_t &size, uint div)
+// ----------------------------------------------------------------------------
+//   Divide num by div in place, update its size and return the remainder
+// ----------------------------------------------------------------------------
+//   div must be below 2^24
+{
+    uint rem = 0;
+    for (size_t i = size; i > 0; i--)
+    {
+        rem = (rem << 8) | num[i - 1];
+        num[i - 1] = byte(rem / div);
+        rem %= div;
+    }
+    while (size > 0 && num[size - 1] == 0)
+        size--;
+    return rem;
+}
+
+
 static size_t render_num(renderer &r,
                          bignum_p  num,
                          uint      base,
@@ -161,38 +221,76 @@ static size_t render_num(renderer &r,
     else
         r.flush();
 
-    // Get denominator for the base
-    size_t findex = r.size();
-    bignum_g b = rt.make<bignum>(object::ID_bignum, base);
-    bignum_g n = (bignum *) num;
-
-    // Keep dividing by the base until we get 0
-    uint sep = 0;
-    do
+    // Digits are generated from the lowest, then reverted
+    size_t   findex = r.size();
+    uint     sep    = 0;
+    bignum_g n      = (bignum *) num;
+    auto     digit  = [&](uint d, bool more)
     {
-        bignum_g remainder = nullptr;
-        bignum_g quotient = nullptr;
-        if (!bignum::quorem(n, b, bignum::ID_bignum, &quotient, &remainder))
-            break;
-        uint digit = remainder->value<uint>();
-        if (digit > base)
-        {
-            printf("Ooops: digit=%u, base=%u\n", digit, base);
-            bignum::quorem(n, b, bignum::ID_bignum, &quotient, &remainder);
-        }
-        unicode c = upper        ? fancy_upper_digits[digit]
-                  : lower        ? fancy_lower_digits[digit]
-                  : (digit < 10) ? digit + '0'
-                                 : digit + ('A' - 10);
+        unicode c = upper   ? fancy_upper_digits[d]
+                  : lower   ? fancy_lower_digits[d]
+                  : (d < 10) ? d + '0'
+                             : d + ('A' - 10);
         r.put(c);
-        n = quotient;
-
-        if (!n->is_zero() && ++sep == spacing)
+        if (more && ++sep == spacing)
         {
             sep = 0;
             r.put(space);
         }
-    } while (!n->is_zero());
+    };
+
+    size_t size = 0;
+    byte_p bytes = n->value(&size);
+    if ((base & (base - 1)) == 0)
+    {
+        // Power of two: extract the bits of each digit directly
+        uint bits = 0;
+        while ((1U << bits) < base)
+            bits++;
+        size_t high = size;
+        while (high && !bytes[high - 1])
+            high--;                             // Not always normalized
+        size_t total = 8 * high;
+        if (high)
+            for (byte top = bytes[high - 1]; !(top & 0x80); top <<= 1)
+                total--;
+        size_t count = total ? (total + bits - 1) / bits : 1;
+        for (size_t d = 0; d < count; d++)
+        {
+            bytes = n->value(&size);            // Re-read after potential GC
+            size_t bit = d * bits;
+            size_t idx = bit / 8;
+            uint   v   = idx < size ? bytes[idx] : 0;
+            if (idx + 1 < size)
+                v |= bytes[idx + 1] << 8;
+            digit((v >> (bit % 8)) & (base - 1), d + 1 < count);
+        }
+    }
+    else
+    {
+        // Other bases: divide a private copy by the largest power of the
+        // base that fits, and get several digits from each remainder
+        uint     chunk = 0;
+        uint     power = bignum::chunk_power(base, &chunk);
+        gcbytes  src   = bytes;
+        bignum_g work  = rt.make<bignum>(object::ID_bignum, src, size);
+        if (!work)
+            return r.size();
+        do
+        {
+            byte *w   = (byte *) work->value(nullptr);
+            uint  rem = bignum::div_rem(w, size, power);
+            for (uint i = 0; i < chunk; i++)
+            {
+                uint d = rem % base;
+                rem /= base;
+                bool more = size || rem;
+                digit(d, more);
+                if (!more)
+                    break;
+            }
+        } while (size);
+    }
 
     // Revert the digits
     byte *dest  = (byte *) r.text();
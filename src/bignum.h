@@ -190,6 +190,11 @@ public:
     static bignum_g pow(bignum_r y, bignum_r x);
     static bignum_p shift(bignum_r x, int bits, bool rotate, bool arith);
 
+    // In-place operations on magnitudes with a small operand, for conversions
+    static uint   chunk_power(uint base, uint *digits = nullptr);
+    static size_t mul_add(byte *num, size_t size, size_t max, uint mul, uint add);
+    static uint   div_rem(byte *num, size_t &size, uint div);
+
     static bignum_p promote(object_p ival);
 
 public:
@@ -64,24 +64,126 @@ MENU_BODY(Catalog)
 }
 
 
-static uint matches(utf8 start, size_t size, utf8 name)
+static uint matches(utf8 filter, size_t size, utf8 name)
 // ----------------------------------------------------------------------------
-//   Check if what was typed matches the name
+//   Check if a lowercase filter matches the name, return offset + 1
 // ----------------------------------------------------------------------------
 {
-    size_t len   = strlen(cstring(name));
-    uint found = 0;
-    for (uint o = 0; !found && o + size <= len; o++)
+    size_t len = strlen(cstring(name));
+    if (!size)
+        return 1;
+    for (uint o = 0; o + size <= len; o++)
     {
-        found = o+1;
-        for (uint i = 0; found && i < size; i++)
-            if (tolower(start[i]) != tolower(name[i + o]))
-                found = 0;
+        if (tolower(name[o]) == filter[0])
+        {
+            uint i = 1;
+            while (i < size && tolower(name[i + o]) == filter[i])
+                i++;
+            if (i == size)
+                return o + 1;
+        }
     }
-    return found;
+    return 0;
 }
 
 
+// ============================================================================
+//
+//   Incremental filtering of the catalog
+//
+// ============================================================================
+//
+//   The catalog is recomputed on each keystroke, first to count the items,
+//   then to list them. The matches for the current filter are kept as
+//   positions in sorted_ids, in increasing order, with a flag for matches
+//   at the beginning of the name. When the filter is extended, only the
+//   previous matches need to be checked again.
+
+enum
+{
+    MAX_FILTER   = 32,          // Longest filter we remember
+    PREFIX_MATCH = 0x8000,      // Flag for matches at beginning of name
+};
+
+static uint16_t *catalog_matches     = nullptr;
+static size_t    catalog_count       = 0;
+static size_t    catalog_filter_size = 0;
+static bool      catalog_valid       = false;
+static byte      catalog_filter[MAX_FILTER];
+
+
+bool Catalog::filter_commands(utf8 start, size_t size)
+// ----------------------------------------------------------------------------
+//   Compute the catalog entries matching what was typed
+// ----------------------------------------------------------------------------
+{
+    if (!sorted_ids && !initialize_sorted_ids())
+        return false;
+    if (!catalog_matches)
+    {
+        catalog_matches = (uint16_t *) malloc(sorted_ids_count *
+                                              sizeof(catalog_matches[0]));
+        if (!catalog_matches)
+        {
+            record(catalog_error,
+                   "No memory for %u matches", uint(sorted_ids_count));
+            return false;
+        }
+        catalog_valid = false;
+    }
+
+    // Case-fold the filter once
+    byte   folded[MAX_FILTER];
+    bool   cached = size <= MAX_FILTER;
+    byte  *filter = cached ? folded : (byte *) start;
+    if (cached)
+        for (size_t i = 0; i < size; i++)
+            folded[i] = tolower(start[i]);
+
+    // If the previous filter is a prefix, only check the previous matches
+    bool incremental = cached && catalog_valid &&
+        catalog_filter_size <= size &&
+        memcmp(catalog_filter, folded, catalog_filter_size) == 0;
+    if (incremental && catalog_filter_size == size)
+        return true;
+
+    size_t candidates = incremental ? catalog_count : sorted_ids_count;
+    size_t count      = 0;
+    for (size_t c = 0; c < candidates; c++)
+    {
+        uint16_t i    = incremental ? catalog_matches[c] & ~PREFIX_MATCH : c;
+        cstring  name = object::spellings[sorted_ids[i]].name;
+        if (cached)
+        {
+            if (uint found = matches(filter, size, utf8(name)))
+                catalog_matches[count++] = i | (found==1 ? PREFIX_MATCH : 0);
+        }
+        else
+        {
+            // Compare without folding the filter, like before
+            size_t len   = strlen(name);
+            uint   found = 0;
+            for (uint o = 0; !found && o + size <= len; o++)
+            {
+                found = o + 1;
+                for (uint j = 0; found && j < size; j++)
+                    if (tolower(filter[j]) != tolower(name[j + o]))
+                        found = 0;
+            }
+            if (found)
+                catalog_matches[count++] = i | (found==1 ? PREFIX_MATCH : 0);
+        }
+    }
+    catalog_count = count;
+    catalog_valid = cached;
+    if (cached)
+    {
+        memcpy(catalog_filter, folded, size);
+        catalog_filter_size = size;
+    }
+    return true;
+}
+
 
 uint Catalog::count_commands()
 // ----------------------------------------------------------------------------
@@ -91,8 +193,18 @@ uint Catalog::count_commands()
     utf8   start  = 0;
     size_t size   = 0;
     bool   filter = ui.current_word(start, size);
-    uint   count  = 0;
 
+    if (filter_commands(start, filter ? size : 0))
+        return filter ? catalog_count : sorted_ids_count;
+
+    // Fallback if we did not have enough memory for sorted_ids
+    byte folded[MAX_FILTER];
+    if (size > MAX_FILTER)
+        size = MAX_FILTER;
+    for (size_t i = 0; i < size; i++)
+        folded[i] = tolower(start[i]);
+
+    uint count = 0;
     for (size_t i = 0; i < spelling_count; i++)
     {
         object::id ty = object::spellings[i].type;
@@ -100,7 +212,7 @@ uint Catalog::count_commands()
             continue;
 
         if (cstring name = spellings[i].name)
-            if (!filter || matches(start, size, utf8(name)))
+            if (!filter || matches(folded, size, utf8(name)))
                 count++;
     }
 
@@ -117,29 +229,30 @@ void Catalog::list_commands(info &mi)
     size_t size   = 0;
     bool   filter = ui.current_word(start, size);
 
-    if (!sorted_ids)
-        initialize_sorted_ids();
-
-    if (sorted_ids)
+    if (filter_commands(start, filter ? size : 0))
     {
-        for (uint pass = 0; pass < uint(filter) + 1; pass++)
+        if (!filter)
         {
             for (size_t i = 0; i < sorted_ids_count; i++)
             {
-                uint16_t j = sorted_ids[i];
-                auto &s = object::spellings[j];
-                id ty  = s.type;
-                if (cstring name = s.name)
+                auto &s = object::spellings[sorted_ids[i]];
+                menu::items(mi, s.name, command::static_object(s.type));
+            }
+            return;
+        }
+
+        // Matches at the beginning of the name come first
+        for (uint pass = 0; pass < 2; pass++)
+        {
+            for (size_t m = 0; m < catalog_count; m++)
+            {
+                uint16_t match  = catalog_matches[m];
+                bool     prefix = match & PREFIX_MATCH;
+                if (prefix == !pass)
                 {
-                    uint ok = !filter;
-                    if (!ok)
-                    {
-                        ok = matches(start, size, utf8(name));
-                        if (ok)
-                            ok = pass ? ok != 1 : ok == 1;
-                    }
-                    if (ok)
-                        menu::items(mi, name, command::static_object(ty));
+                    uint16_t i = match & ~PREFIX_MATCH;
+                    auto    &s = object::spellings[sorted_ids[i]];
+                    menu::items(mi, s.name, command::static_object(s.type));
                 }
             }
         }
@@ -147,12 +260,18 @@ void Catalog::list_commands(info &mi)
     else
     {
         // Fallback if we did not have enough memory for sorted_ids
+        byte folded[MAX_FILTER];
+        if (size > MAX_FILTER)
+            size = MAX_FILTER;
+        for (size_t i = 0; i < size; i++)
+            folded[i] = tolower(start[i]);
+
         for (size_t i = 0; i < spelling_count; i++)
         {
             object::id ty = object::spellings[i].type;
             if (object::is_command(ty))
                 if (cstring name = spellings[i].name)
-                    if (!filter || matches(start, size, utf8(name)))
+                    if (!filter || matches(folded, size, utf8(name)))
                         menu::items(mi, name, command::static_object(ty));
         }
     }
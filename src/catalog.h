@@ -39,6 +39,7 @@ struct Catalog : menu
 {
     Catalog(id type = ID_Catalog): menu(type) {}
 
+    static bool filter_commands(utf8 start, size_t size);
     static uint count_commands();
     static void list_commands(info &mi);
 
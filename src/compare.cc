@@ -246,6 +246,23 @@ object::result comparison::compare(comparison_fn comparator, id op)
     object_p y = rt.stack(0);
     if (!x || !y)
         return ERROR;
+
+    // Fast path for small integers, e.g. loop termination tests
+    id     xt, yt;
+    ularge xv, yv;
+    if (small_integer(x, xt, xv) && small_integer(y, yt, yv))
+    {
+        int cmp = (xv > yv) - (xv < yv);
+        if (xt != yt)
+            cmp = xt == ID_neg_integer ? -1 : 1;
+        else if (xt == ID_neg_integer)
+            cmp = -cmp;
+        id type = comparator(cmp) ? ID_True : ID_False;
+        if (rt.drop(2) && rt.push(command::static_object(type)))
+            return OK;
+        return ERROR;
+    }
+
     if (!x->is_extended_algebraic() || !y->is_extended_algebraic())
     {
         rt.type_error();
@@ -0,0 +1,499 @@
+// ****************************************************************************
+//  compiled.cc                                                   DB48X project
+// ****************************************************************************
+//
+//   File Description:
+//
+//     Compilation of numerical functions to hardware floating-point code
+//
+//
+//
+//
+//
+//
+//
+//
+// ****************************************************************************
+//   (C) 2024 Christophe de Dinechin <christophe@dinechin.org>
+//   This software is licensed under the terms outlined in LICENSE.txt
+// ****************************************************************************
+//   This file is part of DB48X.
+//
+//   DB48X is free software: you can redistribute it and/or modify
+//   it under the terms outlined in the LICENSE.txt file
+//
+//   DB48X is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include "compiled.h"
+
+#include "constants.h"
+#include "decimal.h"
+#include "expression.h"
+#include "hwfp.h"
+#include "integer.h"
+#include "recorder.h"
+#include "settings.h"
+#include "symbol.h"
+#include "variables.h"
+
+#include <cmath>
+
+RECORDER(compiled, 16, "Compiled numerical functions");
+
+
+compiled_function::compiled_function(program_r eq, uint digits)
+// ----------------------------------------------------------------------------
+//   Compile the function if possible
+// ----------------------------------------------------------------------------
+    : eq(eq),
+      code(),
+      constants(),
+      length(0),
+      count(0),
+      depth(1),
+      bottom(1)
+{
+    // If the interpreter would use hwfp anyway, we can use doubles
+    bool hwfp = (Settings.HardwareFloatingPoint() &&
+                 Settings.Precision() <= 16);
+    if (eq && (digits <= MAX_DIGITS || hwfp) && !compile())
+        length = 0;
+    record(compiled, "Compiled %t to %u ops, %u constants",
+           +eq, length, count);
+}
+
+
+bool compiled_function::emit(id op, int pop, int push)
+// ----------------------------------------------------------------------------
+//   Emit an operation, checking stack depth and code size
+// ----------------------------------------------------------------------------
+{
+    if (length >= MAX_CODE)
+        return false;
+    depth -= pop;
+    if (depth < 0)
+        return false;
+    if (bottom > depth)
+        bottom = depth;
+    depth += push;
+    if (depth > MAX_DEPTH)
+        return false;
+    code[length++] = op;
+    return true;
+}
+
+
+bool compiled_function::constant(algebraic_r value)
+// ----------------------------------------------------------------------------
+//   Emit a constant
+// ----------------------------------------------------------------------------
+{
+    double fp = 0.0;
+    if (count >= MAX_CONSTANTS || !as_double(value, fp) || !std::isfinite(fp))
+        return false;
+    if (!emit(object::ID_hwdouble, 0, 1) || length >= MAX_CODE)
+        return false;
+    code[length++] = count;
+    constants[count++] = fp;
+    return true;
+}
+
+
+bool compiled_function::compile()
+// ----------------------------------------------------------------------------
+//   Compile the function, return false if anything cannot be compiled
+// ----------------------------------------------------------------------------
+//   The stack initially contains X, like in algebraic::evaluate_function.
+//   At the end, the function may either have consumed X and left a single
+//   result, or left X untouched with the result above it.
+{
+    bool numerical = Settings.NumericalConstants() || Settings.NumericalResults();
+    bool angles    = Settings.SetAngleUnits();
+
+    for (object_p obj : *eq)
+    {
+        id ty = obj->type();
+        switch(ty)
+        {
+        case object::ID_symbol:
+        {
+            symbol_p name = symbol_p(obj);
+            if (expression::independent &&
+                name->is_same_as(*expression::independent))
+            {
+                if (!emit(object::ID_symbol, 0, 1))
+                    return false;
+                break;
+            }
+            if (expression::dependent &&
+                name->is_same_as(*expression::dependent))
+                return false;
+
+            // Other variables are evaluated once, must be real numbers
+            object_p value = directory::recall_all(obj, false);
+            if (!value || !value->is_real())
+                return false;
+            if (!constant(algebraic_p(value)))
+                return false;
+            break;
+        }
+
+        case object::ID_constant:
+        {
+            if (!numerical)
+                return false;
+            algebraic_g value = constant_p(obj)->numerical_value();
+            if (!value || !value->is_real() || !constant(value))
+                return false;
+            break;
+        }
+
+        case object::ID_asin:
+        case object::ID_acos:
+        case object::ID_atan:
+        case object::ID_atan2:
+            // With angle units, the result would be a unit object
+            if (angles)
+                return false;
+            if (!emit(ty, ty == object::ID_atan2 ? 2 : 1, 1))
+                return false;
+            break;
+
+        case object::ID_add:
+        case object::ID_sub:
+        case object::ID_mul:
+        case object::ID_div:
+        case object::ID_pow:
+        case object::ID_mod:
+        case object::ID_rem:
+        case object::ID_hypot:
+        case object::ID_Min:
+        case object::ID_Max:
+            if (!emit(ty, 2, 1))
+                return false;
+            break;
+
+        case object::ID_neg:
+        case object::ID_abs:
+        case object::ID_sign:
+        case object::ID_inv:
+        case object::ID_sq:
+        case object::ID_cubed:
+        case object::ID_sqrt:
+        case object::ID_cbrt:
+        case object::ID_sin:
+        case object::ID_cos:
+        case object::ID_tan:
+        case object::ID_sinh:
+        case object::ID_cosh:
+        case object::ID_tanh:
+        case object::ID_asinh:
+        case object::ID_acosh:
+        case object::ID_atanh:
+        case object::ID_log:
+        case object::ID_exp:
+        case object::ID_log10:
+        case object::ID_exp10:
+        case object::ID_log2:
+        case object::ID_exp2:
+        case object::ID_log1p:
+        case object::ID_expm1:
+        case object::ID_erf:
+        case object::ID_erfc:
+        case object::ID_tgamma:
+            if (!emit(ty, 1, 1))
+                return false;
+            break;
+
+        default:
+            if (!object::is_real(ty))
+                return false;
+            if (!constant(algebraic_g(algebraic_p(obj))))
+                return false;
+            break;
+        }
+    }
+
+    return depth == 1 || (depth == 2 && bottom >= 1);
+}
+
+
+#ifdef DM42
+#  pragma GCC push_options
+#  pragma GCC optimize("-O3")
+#endif // DM42
+
+static inline double modulo(double x, double y)
+// ----------------------------------------------------------------------------
+//   Modulo with the same sign rules as hwfp::mod
+// ----------------------------------------------------------------------------
+{
+    x = std::fmod(x, y);
+    if (x < 0)
+        x = y < 0 ? x - y : x + y;
+    return x;
+}
+
+
+bool compiled_function::run(double x, double &y) const
+// ----------------------------------------------------------------------------
+//   Run the compiled code for a single value
+// ----------------------------------------------------------------------------
+{
+    return run(&x, &y, 1);
+}
+
+
+bool compiled_function::run(const double *x, double *y, uint count) const
+// ----------------------------------------------------------------------------
+//   Run the compiled code for a batch of values
+// ----------------------------------------------------------------------------
+//   Each operation is applied to up to BATCH values at once, so that
+//   decoding is paid once per batch, and the inner loops are simple enough
+//   for the compiler to unroll or vectorize them
+{
+    double stack[MAX_DEPTH][BATCH];
+    bool   finite = true;
+
+#define UNARY(op, expr)                         \
+    case object::ID_##op:                       \
+    {                                           \
+        double *pa = stack[sp-1];               \
+        for (uint i = 0; i < n; i++)            \
+        {                                       \
+            double a = pa[i];                   \
+            pa[i] = expr;                       \
+        }                                       \
+        break;                                  \
+    }
+#define BINARY(op, expr)                        \
+    case object::ID_##op:                       \
+    {                                           \
+        sp--;                                   \
+        double *pa = stack[sp-1];               \
+        double *pb = stack[sp];                 \
+        for (uint i = 0; i < n; i++)            \
+        {                                       \
+            double a = pa[i];                   \
+            double b = pb[i];                   \
+            pa[i] = expr;                       \
+        }                                       \
+        break;                                  \
+    }
+
+    while (count)
+    {
+        uint n  = count < BATCH ? count : BATCH;
+        uint sp = 1;
+        for (uint i = 0; i < n; i++)
+            stack[0][i] = x[i];
+
+        for (uint pc = 0; pc < length; pc++)
+        {
+            switch(code[pc])
+            {
+            case object::ID_symbol:
+                for (uint i = 0; i < n; i++)
+                    stack[sp][i] = x[i];
+                sp++;
+                break;
+            case object::ID_hwdouble:
+            {
+                double c = constants[code[++pc]];
+                for (uint i = 0; i < n; i++)
+                    stack[sp][i] = c;
+                sp++;
+                break;
+            }
+
+            BINARY(add,     a + b);
+            BINARY(sub,     a - b);
+            BINARY(mul,     a * b);
+            BINARY(div,     a / b);
+            BINARY(pow,     std::pow(a, b));
+            BINARY(mod,     modulo(a, b));
+            BINARY(rem,     std::fmod(a, b));
+            BINARY(hypot,   std::hypot(a, b));
+            BINARY(atan2,   hwdouble::to_angle(std::atan2(a, b)));
+            BINARY(Min,     a < b ? a : b);
+            BINARY(Max,     a > b ? a : b);
+
+            UNARY(neg,      -a);
+            UNARY(abs,      std::fabs(a));
+            UNARY(sign,     double((a > 0) - (a < 0)));
+            UNARY(inv,      1.0 / a);
+            UNARY(sq,       a * a);
+            UNARY(cubed,    a * a * a);
+            UNARY(sqrt,     std::sqrt(a));
+            UNARY(cbrt,     std::cbrt(a));
+            UNARY(sin,      std::sin(hwdouble::from_angle(a)));
+            UNARY(cos,      std::cos(hwdouble::from_angle(a)));
+            UNARY(tan,      std::tan(hwdouble::from_angle(a)));
+            UNARY(asin,     hwdouble::to_angle(std::asin(a)));
+            UNARY(acos,     hwdouble::to_angle(std::acos(a)));
+            UNARY(atan,     hwdouble::to_angle(std::atan(a)));
+            UNARY(sinh,     std::sinh(a));
+            UNARY(cosh,     std::cosh(a));
+            UNARY(tanh,     std::tanh(a));
+            UNARY(asinh,    std::asinh(a));
+            UNARY(acosh,    std::acosh(a));
+            UNARY(atanh,    std::atanh(a));
+            UNARY(log,      std::log(a));
+            UNARY(exp,      std::exp(a));
+            UNARY(log10,    std::log10(a));
+            UNARY(exp10,    std::pow(10.0, a));
+            UNARY(log2,     std::log2(a));
+            UNARY(exp2,     std::exp2(a));
+            UNARY(log1p,    std::log1p(a));
+            UNARY(expm1,    std::expm1(a));
+            UNARY(erf,      std::erf(a));
+            UNARY(erfc,     std::erfc(a));
+            UNARY(tgamma,   std::tgamma(a));
+
+            default:
+                return false;
+            }
+        }
+
+        for (uint i = 0; i < n; i++)
+        {
+            y[i] = stack[sp-1][i];
+            if (!std::isfinite(y[i]))
+                finite = false;
+        }
+        x += n;
+        y += n;
+        count -= n;
+    }
+
+#undef UNARY
+#undef BINARY
+
+    return finite;
+}
+
+#ifdef DM42
+#  pragma GCC pop_options
+#endif // DM42
+
+
+bool compiled_function::run(double x, double dx, double *y, uint count) const
+// ----------------------------------------------------------------------------
+//   Run the compiled code for x + i * dx, i in [0, count)
+// ----------------------------------------------------------------------------
+{
+    double xs[BATCH];
+    bool   finite = true;
+    for (uint i = 0; i < count; i += BATCH)
+    {
+        uint n = count - i < BATCH ? count - i : BATCH;
+        for (uint j = 0; j < n; j++)
+            xs[j] = x + (i + j) * dx;
+        if (!run(xs, y + i, n))
+            finite = false;
+    }
+    return finite;
+}
+
+
+algebraic_p compiled_function::sum(algebraic_r x, algebraic_r dx,
+                                   uint count) const
+// ----------------------------------------------------------------------------
+//   Sum f(x + i * dx) for i in [0, count), or nullptr to use the interpreter
+// ----------------------------------------------------------------------------
+{
+    double fx = 0.0, fdx = 0.0;
+    if (!length || !as_double(x, fx) || !as_double(dx, fdx))
+        return nullptr;
+
+    // Kahan compensated summation, so that long sums do not drift
+    double ys[BATCH];
+    double sum   = 0.0;
+    double carry = 0.0;
+    for (uint i = 0; i < count; i += BATCH)
+    {
+        uint n = count - i < BATCH ? count - i : BATCH;
+        if (!run(fx + i * fdx, fdx, ys, n))
+            return nullptr;
+        for (uint j = 0; j < n; j++)
+        {
+            double y = ys[j] - carry;
+            double t = sum + y;
+            carry = (t - sum) - y;
+            sum = t;
+        }
+    }
+    return std::isfinite(sum) ? from_double(sum) : nullptr;
+}
+
+
+algebraic_p compiled_function::evaluate(algebraic_r x) const
+// ----------------------------------------------------------------------------
+//   Evaluate the function for x, using compiled code if possible
+// ----------------------------------------------------------------------------
+{
+    double fx = 0.0, fy = 0.0;
+    if (length && as_double(x, fx) && run(fx, fy))
+        if (algebraic_p y = from_double(fy))
+            return y;
+    return algebraic::evaluate_function(eq, x);
+}
+
+
+bool compiled_function::as_double(algebraic_r x, double &value)
+// ----------------------------------------------------------------------------
+//   Convert a real value to double
+// ----------------------------------------------------------------------------
+{
+    if (!x)
+        return false;
+    id ty = x->type();
+    switch(ty)
+    {
+    case object::ID_integer:
+        value = double(integer_p(+x)->value<ularge>());
+        return true;
+    case object::ID_neg_integer:
+        value = -double(integer_p(+x)->value<ularge>());
+        return true;
+    case object::ID_hwfloat:
+        value = hwfloat_p(+x)->value();
+        return true;
+    case object::ID_hwdouble:
+        value = hwdouble_p(+x)->value();
+        return true;
+    case object::ID_decimal:
+    case object::ID_neg_decimal:
+        value = decimal_p(+x)->to_double();
+        return true;
+    default:
+        break;
+    }
+    if (!object::is_real(ty))
+        return false;
+    algebraic_g d = x;
+    if (!algebraic::to_decimal(d) || !object::is_decimal(d->type()))
+        return false;
+    value = decimal_p(+d)->to_double();
+    return true;
+}
+
+
+algebraic_p compiled_function::from_double(double value)
+// ----------------------------------------------------------------------------
+//   Build the result with the type the interpreter would normally use
+// ----------------------------------------------------------------------------
+{
+    if (Settings.HardwareFloatingPoint())
+    {
+        uint prec = Settings.Precision();
+        if (prec <= 7)
+            return hwfloat::make(float(value));
+        if (prec <= 16)
+            return hwdouble::make(value);
+    }
+    return decimal::from(value);
+}
@@ -0,0 +1,110 @@
+#ifndef COMPILED_H
+#define COMPILED_H
+// ****************************************************************************
+//  compiled.h                                                    DB48X project
+// ****************************************************************************
+//
+//   File Description:
+//
+//    Numerical closures: a function of one variable compiled once into a
+//    flat sequence of hardware floating-point operations
+//
+//    Plotting, numerical integration and the solver evaluate the same
+//    function for many values of the independent variable. Going through
+//    the RPL interpreter for each evaluation means pushing the value,
+//    looking up variables and allocating intermediate objects every time.
+//    When a function only contains numbers, the independent variable and
+//    real-valued arithmetic or transcendental functions, it can instead be
+//    compiled once into a small stack machine program over double values.
+//
+//    Anything that cannot be compiled (units, complex values, local
+//    variables, user-defined functions, ...) leaves the closure empty,
+//    and evaluation falls back to the interpreter. The interpreter is also
+//    used for individual points where the compiled code produces a value
+//    that is not finite, so that errors are reported exactly as before.
+//
+// ****************************************************************************
+//   (C) 2024 Christophe de Dinechin <christophe@dinechin.org>
+//   This software is licensed under the terms outlined in LICENSE.txt
+// ****************************************************************************
+//   This file is part of DB48X.
+//
+//   DB48X is free software: you can redistribute it and/or modify
+//   it under the terms outlined in the LICENSE.txt file
+//
+//   DB48X is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include "algebraic.h"
+#include "program.h"
+
+
+struct compiled_function
+// ----------------------------------------------------------------------------
+//   A function of the independent variable compiled to hardware FP code
+// ----------------------------------------------------------------------------
+{
+    typedef object::id id;
+    enum
+    {
+        MAX_CODE      = 48,     // Maximum number of operations
+        MAX_CONSTANTS = 16,     // Maximum number of constants
+        MAX_DEPTH     = 8,      // Maximum depth of the evaluation stack
+        BATCH         = 8,      // Values evaluated together in a batch
+        MAX_DIGITS    = 15,     // Digits we can reliably get from a double
+    };
+
+    compiled_function(program_r eq, uint digits = 0);
+    // ------------------------------------------------------------------------
+    //   Compile eq if possible and if doubles are accurate enough for digits
+    // ------------------------------------------------------------------------
+
+    bool compiled() const
+    // ------------------------------------------------------------------------
+    //   Check if we have code to run
+    // ------------------------------------------------------------------------
+    {
+        return length != 0;
+    }
+
+    algebraic_p evaluate(algebraic_r x) const;
+    // ------------------------------------------------------------------------
+    //   Evaluate for x, falling back to the interpreter when necessary
+    // ------------------------------------------------------------------------
+
+    bool run(double x, double &y) const;
+    bool run(const double *x, double *y, uint count) const;
+    bool run(double x, double dx, double *y, uint count) const;
+    // ------------------------------------------------------------------------
+    //   Run the compiled code, return false if a result is not finite
+    // ------------------------------------------------------------------------
+
+    algebraic_p sum(algebraic_r x, algebraic_r dx, uint count) const;
+    // ------------------------------------------------------------------------
+    //   Sum of f(x + i*dx) for i in [0, count), nullptr if not compiled
+    // ------------------------------------------------------------------------
+
+    static bool        as_double(algebraic_r x, double &value);
+    static algebraic_p from_double(double value);
+    // ------------------------------------------------------------------------
+    //   Conversions between algebraic values and double
+    // ------------------------------------------------------------------------
+
+protected:
+    bool compile();
+    bool emit(id op, int pop, int push);
+    bool constant(algebraic_r value);
+
+protected:
+    program_g   eq;                     // Original function, for fallback
+    uint16_t    code[MAX_CODE];         // Operations, as object IDs
+    double      constants[MAX_CONSTANTS];
+    uint        length;                 // Length of the code
+    uint        count;                  // Number of constants
+    int         depth;                  // Stack depth during compilation
+    int         bottom;                 // Depth where X was consumed
+};
+
+#endif // COMPILED_H
@@ -471,6 +471,204 @@ size_t constant::do_rendering(config_r cfg, constant_p o, renderer &r)
 }
 
 
+// ============================================================================
+//
+//   Registry of entries
+//
+// ============================================================================
+//
+//   Without a registry, each lookup reads and tokenizes the file from the
+//   beginning, and each use of a definition parses it again. The registry
+//   records where each entry is and the hash of its name, and keeps copies
+//   of recently parsed definitions outside of the runtime memory.
+//   The index is rebuilt when the file stamp changes, and the parsed
+//   definitions are dropped when settings that affect parsing change.
+
+static uint32_t registry_hash(utf8 txt, size_t len)
+// ----------------------------------------------------------------------------
+//   FNV-1a hash of a name or definition
+// ----------------------------------------------------------------------------
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++)
+        hash = (hash ^ txt[i]) * 16777619u;
+    return hash;
+}
+
+
+static void registry_flush(constant::registry &reg)
+// ----------------------------------------------------------------------------
+//   Drop the cached parsed definitions
+// ----------------------------------------------------------------------------
+{
+    for (uint i = 0; i < reg.CACHED; i++)
+    {
+        free(reg.values[i].data);
+        reg.values[i].data = nullptr;
+    }
+    reg.next = 0;
+}
+
+
+static bool registry_update(constant::config_r cfg, unit_file &cfile)
+// ----------------------------------------------------------------------------
+//   Make sure the index matches the current file, return false if no index
+// ----------------------------------------------------------------------------
+{
+    constant::registry &reg   = *cfg.cache;
+    uint                stamp = cfile.stamp();
+    if (reg.entries && reg.stamp == stamp)
+        return true;
+
+    record(constants, "Building index for %s, stamp %u", cfg.file, stamp);
+    registry_flush(reg);
+    free(reg.entries);
+    free(reg.hashes);
+    reg.entries = nullptr;
+    reg.hashes  = nullptr;
+    reg.count   = 0;
+
+    // Count entries in the file and in the builtins
+    size_t maxb     = cfg.nbuiltins;
+    auto   builtins = cfg.builtins;
+    uint   count    = 0;
+    if (cfile.valid())
+    {
+        cfile.seek(0);
+        while (cfile.next(true))
+            while (cfile.next(false))
+                count++;
+    }
+    for (size_t b = 0; b < maxb; b += 2)
+        if (builtins[b+1] && *builtins[b+1])
+            count++;
+
+    reg.entries = (uint32_t *) malloc(count * sizeof(reg.entries[0]));
+    reg.hashes  = (uint16_t *) malloc(count * sizeof(reg.hashes[0]));
+    if (!reg.entries || !reg.hashes)
+    {
+        record(constants_error, "No memory to index %u entries", count);
+        free(reg.entries);
+        free(reg.hashes);
+        reg.entries = nullptr;
+        reg.hashes  = nullptr;
+        return false;
+    }
+
+    // Record where each entry is, and the hash of its name
+    uint idx = 0;
+    if (cfile.valid())
+    {
+        cfile.seek(0);
+        while (cfile.next(true))
+        {
+            uint position = cfile.position();
+            while (symbol_p name = cfile.next(false))
+            {
+                if (idx >= count)
+                    break;
+                size_t len = 0;
+                utf8   txt = name->value(&len);
+                reg.entries[idx] = position;
+                reg.hashes[idx++] = registry_hash(txt, len);
+                position = cfile.position();
+            }
+        }
+    }
+    for (size_t b = 0; b < maxb && idx < count; b += 2)
+    {
+        if (builtins[b+1] && *builtins[b+1])
+        {
+            cstring txt = builtins[b];
+            reg.entries[idx] = reg.BUILTIN | b;
+            reg.hashes[idx++] = registry_hash(utf8(txt), strlen(txt));
+        }
+    }
+    reg.count = idx;
+    reg.stamp = stamp;
+    return true;
+}
+
+
+static utf8 registry_name(constant::config_r cfg, unit_file &cfile,
+                          uint idx, size_t *len)
+// ----------------------------------------------------------------------------
+//   Return the name of an indexed entry
+// ----------------------------------------------------------------------------
+{
+    constant::registry &reg = *cfg.cache;
+    if (idx >= reg.count)
+        return nullptr;
+
+    uint32_t entry = reg.entries[idx];
+    if (entry & reg.BUILTIN)
+    {
+        cstring txt = cfg.builtins[entry & ~reg.BUILTIN];
+        if (len)
+            *len = strlen(txt);
+        return utf8(txt);
+    }
+    cfile.seek(entry);
+    if (symbol_p name = cfile.next(false))
+        return name->value(len);
+    return nullptr;
+}
+
+
+object_p constant::parse_definition(config_r cfg, symbol_r def)
+// ----------------------------------------------------------------------------
+//   Parse a definition, reusing a previous parse if possible
+// ----------------------------------------------------------------------------
+{
+    if (!def)
+        return nullptr;
+
+    size_t len = 0;
+    utf8   txt = def->value(&len);
+    if (!cfg.cache)
+        return object::parse(txt, len);
+
+    registry &reg      = *cfg.cache;
+    uint      settings = Settings.Precision()
+                       | Settings.Base() << 16
+                       | Settings.HardwareFloatingPoint() << 24;
+    if (reg.settings != settings)
+    {
+        registry_flush(reg);
+        reg.settings = settings;
+    }
+
+    uint32_t hash = registry_hash(txt, len);
+    for (uint i = 0; i < reg.CACHED; i++)
+    {
+        registry::parsed &p = reg.values[i];
+        if (p.data && p.hash == hash && p.length == len &&
+            memcmp(p.data, txt, len) == 0)
+            return rt.clone(object_p(p.data + len));
+    }
+
+    object_g obj = object::parse(txt, len);
+    if (!obj)
+        return nullptr;
+
+    // Parsing may have moved the definition
+    txt = def->value(&len);
+    size_t osize = obj->size();
+    if (byte *data = (byte *) malloc(len + osize))
+    {
+        memcpy(data, txt, len);
+        memcpy(data + len, +obj, osize);
+        registry::parsed &p = reg.values[reg.next];
+        free(p.data);
+        p.hash   = hash;
+        p.length = len;
+        p.data   = data;
+        reg.next = (reg.next + 1) % reg.CACHED;
+    }
+    return obj;
+}
+
+
 constant_p constant::do_lookup(config_r cfg, utf8 txt, size_t len, bool error)
 // ----------------------------------------------------------------------------
 //   Scan the table and file to see if there is matching constant
@@ -486,6 +684,25 @@ constant_p constant::do_lookup(config_r cfg, utf8 txt, size_t len, bool error)
     size_t    clen     = 0;
     uint      idx      = 0;
 
+    // Use the index if we have one
+    if (cfg.cache && registry_update(cfg, cfile))
+    {
+        registry &reg  = *cfg.cache;
+        uint16_t  hash = registry_hash(txt, len);
+        for (idx = 0; idx < reg.count; idx++)
+        {
+            if (reg.hashes[idx] == hash)
+            {
+                ctxt = cstring(registry_name(cfg, cfile, idx, &clen));
+                if (ctxt && len == clen && memcmp(txt, ctxt, len) == 0)
+                    return constant::make(cfg.type, idx);
+            }
+        }
+        if (error)
+            cfg.error().source(txt, len);
+        return nullptr;
+    }
+
     // Check in-file constants
     if (cfile.valid())
     {
@@ -533,6 +750,10 @@ utf8 constant::do_name(config_r cfg, size_t *len) const
     cstring   ctxt     = nullptr;
     uint      idx      = index();
 
+    // Use the index if we have one
+    if (cfg.cache && registry_update(cfg, cfile))
+        return registry_name(cfg, cfile, idx, len);
+
     // Check in-file constants
     if (cfile.valid())
     {
@@ -580,8 +801,35 @@ object_p constant::do_value(config_r cfg) const
     size_t    clen     = 0;
     uint      idx      = index();
 
+    // Use the index if we have one
+    bool indexed = cfg.cache && registry_update(cfg, cfile);
+    if (indexed)
+    {
+        registry &reg = *cfg.cache;
+        if (idx < reg.count)
+        {
+            uint32_t entry = reg.entries[idx];
+            if (entry & reg.BUILTIN)
+            {
+                cname = symbol::make(builtins[entry & ~reg.BUILTIN]);
+                csym  = symbol::make(builtins[(entry & ~reg.BUILTIN) + 1]);
+            }
+            else
+            {
+                cfile.seek(entry);
+                cname = cfile.next(false);
+                if (cname)
+                {
+                    utf8 ctxt = cname->value(&clen);
+                    cfile.seek(entry);
+                    csym = cfile.lookup(ctxt, clen, false, false);
+                }
+            }
+        }
+    }
+
     // Check in-file constants
-    if (cfile.valid())
+    if (!indexed && cfile.valid())
     {
         cfile.seek(0);
         while (symbol_g category = cfile.next(true))
@@ -606,7 +854,7 @@ object_p constant::do_value(config_r cfg) const
     }
 
     // Check built-in constants
-    for (size_t b = 0; !csym && b < maxb; b += 2)
+    for (size_t b = 0; !csym && !indexed && b < maxb; b += 2)
     {
         if (builtins[b+1] && *builtins[b+1])
         {
@@ -643,7 +891,7 @@ object_p constant::do_value(config_r cfg) const
         else
         {
             error_save esave;
-            if (object_p obj = object::parse(cdef, clen))
+            if (object_p obj = parse_definition(cfg, csym))
                 return obj;
         }
     }
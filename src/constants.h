@@ -56,6 +56,29 @@ struct constant : algebraic
 
 
     typedef const cstring *builtins_p;
+    struct registry
+    // ------------------------------------------------------------------------
+    //   Index of the entries and cache of parsed definitions
+    // ------------------------------------------------------------------------
+    {
+        enum { BUILTIN = 0x80000000u, CACHED = 16 };
+
+        struct parsed
+        {
+            uint32_t    hash;   // Hash of the definition text
+            uint        length; // Length of the definition text
+            byte *      data;   // Definition text followed by parsed object
+        };
+
+        uint        stamp;      // File stamp when the index was built
+        uint        settings;   // Settings that affect parsing
+        uint        count;      // Number of entries in the index
+        uint32_t *  entries;    // File position, or BUILTIN | builtin index
+        uint16_t *  hashes;     // Hash of the name of each entry
+        uint        next;       // Next parsed entry to replace
+        parsed      values[CACHED];
+    };
+
     struct config
     // ------------------------------------------------------------------------
     //   Configuration for a kind of file-based constants
@@ -77,6 +100,7 @@ struct constant : algebraic
         runtime &  (*error)();  // Emit error message
         symbol_p   (*label)(symbol_r); // Menu label adustment
         bool       (*show_builtins)(); // How to check if we show builtins
+        registry * cache;       // Index and parsed definitions, or null
     };
     typedef const config &config_r;
 
@@ -145,6 +169,7 @@ struct constant : algebraic
     static result    lookup_command(config_r cfg, bool numerical);
     static object_p  lookup_menu(config_r cfg, utf8 name, size_t len);
     static object_p  lookup_menu(config_r cfg, cstring name);
+    static object_p  parse_definition(config_r cfg, symbol_r def);
 
 protected:
     static result     do_parsing(config_r cfg, parser &p);
@@ -31,6 +31,7 @@
 #include "arithmetic.h"
 #include "bignum.h"
 #include "fraction.h"
+#include "integer.h"
 #include "parser.h"
 #include "renderer.h"
 #include "runtime.h"
@@ -3352,8 +3353,19 @@ decimal_p decimal::fact(decimal_r x)
         return tgamma(fp);
     }
 
-    decimal_g r = make(1);
-    for (large i = 2; i <= ip; i++)
+    // Small factorials come from a table, as long as they are exact
+    large small = integer::MAX_SMALL_FACTORIAL;
+    uint  prec  = Settings.Precision();
+    if (prec < 19)
+    {
+        ularge limit = 1;
+        for (uint d = 0; d < prec; d++)
+            limit *= 10;
+        while (integer::small_factorial(small) >= limit)
+            small--;
+    }
+    decimal_g r = make(integer::small_factorial(ip < small ? ip : small));
+    for (large i = small + 1; i <= ip; i++)
     {
         fp = make(i);
         r = r * fp;
@@ -65,6 +65,7 @@ extern int           lcd_buf_cleared_result;
 extern uint32_t      lcd_buffer[SIM_LCD_BUFSIZE];
 extern bool          shift_held;
 extern bool          alt_held;
+extern bool          virtual_clock;
 
 
 // ============================================================================
@@ -102,6 +103,8 @@ int       ui_wrap_io(file_sel_fn callback,
                      bool        writing);
 void      ui_load_keymap(const char *path);
 
+void      virtual_clock_rpl_thread();
+
 #if WASM
 int       ui_init();
 uintptr_t ui_lcd_buffer();
@@ -1318,9 +1318,7 @@ static symbol_p equation_label(symbol_r sym)
 {
     if (sym)
     {
-        size_t   len    = 0;
-        utf8     source = sym->value(&len);
-        if (object_p obj = object::parse(source, len))
+        if (object_p obj = equation::parse_definition(equation::equations, sym))
             if (expression_p expr = obj->as<expression>())
                 if (symbol_p ssym = expr->as_symbol(false))
                     return ssym;
@@ -1329,6 +1327,12 @@ static symbol_p equation_label(symbol_r sym)
 }
 
 
+static constant::registry equation_registry;
+// ----------------------------------------------------------------------------
+//   Index of the equations and recently parsed equations
+// ----------------------------------------------------------------------------
+
+
 static bool show_builtin_equations()
 // ----------------------------------------------------------------------------
 //   Show the builtin equations
@@ -1358,7 +1362,8 @@ const equation::config equation::equations =
     .nbuiltins      = sizeof(basic_equations) / sizeof(*basic_equations),
     .error          = invalid_equation_error,
     .label          = equation_label,
-    .show_builtins  = show_builtin_equations
+    .show_builtins  = show_builtin_equations,
+    .cache          = &equation_registry
 };
 
 
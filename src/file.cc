@@ -35,6 +35,9 @@
 #include "utf8.h"
 
 #include <unistd.h>
+#if SIMULATOR
+#include <sys/stat.h>
+#endif // SIMULATOR
 
 
 
@@ -247,6 +250,25 @@ void file::close()
 }
 
 
+uint file::stamp()
+// ----------------------------------------------------------------------------
+//   Return a value that changes when the file is modified
+// ----------------------------------------------------------------------------
+//   DMCP does not give access to the file date, so we use the file size
+{
+    if (!valid())
+        return 0;
+#if SIMULATOR
+    struct stat st;
+    if (fstat(fileno(data), &st) == 0)
+        return uint(st.st_mtime) * 31 + uint(st.st_size);
+    return 0;
+#else
+    return f_size(&data);
+#endif // SIMULATOR
+}
+
+
 bool file::put(unicode cp)
 // ----------------------------------------------------------------------------
 //   Emit a unicode character in the file
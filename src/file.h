@@ -64,6 +64,7 @@ struct file
     void    seek(uint offset);
     unicode peek();
     uint    position();
+    uint    stamp();
     uint    find(unicode cp);
     uint    find(unicode cp1, unicode cp2);
     uint    rfind(unicode cp);
@@ -41,14 +41,24 @@ static ularge gcd(ularge a, ularge b)
 // ----------------------------------------------------------------------------
 //   Compute the greatest common denominator between a and b
 // ----------------------------------------------------------------------------
+//   This uses the binary GCD, which avoids 64-bit divisions on the DM42
 {
+    if (!a || !b)
+        return a | b;
+    uint shift = __builtin_ctzll(a | b);
+    a >>= __builtin_ctzll(a);
     while (b)
     {
-        ularge na = b;
-        b = a % b;
-        a = na;
+        b >>= __builtin_ctzll(b);
+        if (a > b)
+        {
+            ularge t = a;
+            a = b;
+            b = t;
+        }
+        b -= a;
     }
-    return a;
+    return a << shift;
 }
 
 
@@ -297,33 +307,196 @@ bignum_g big_fraction::denominator() const
 }
 
 
-static bignum_g gcd(bignum_g a, bignum_g b)
+static size_t trailing_zeros(byte_p x, size_t size)
+// ----------------------------------------------------------------------------
+//   Count the trailing zero bits in a non-zero magnitude
+// ----------------------------------------------------------------------------
+{
+    size_t i = 0;
+    while (i < size && !x[i])
+        i++;
+    return i < size ? 8 * i + __builtin_ctz(x[i]) : 8 * size;
+}
+
+
+static void shift_right(byte *x, size_t &size, size_t bits)
+// ----------------------------------------------------------------------------
+//   Shift a magnitude right in place
+// ----------------------------------------------------------------------------
+{
+    size_t bytes = bits / 8;
+    uint   shift = bits % 8;
+    size_t out   = 0;
+    for (size_t i = bytes; i < size; i++)
+    {
+        uint v = x[i] >> shift;
+        if (shift && i + 1 < size)
+            v |= x[i + 1] << (8 - shift);
+        x[out++] = byte(v);
+    }
+    size = out;
+    while (size > 0 && !x[size - 1])
+        size--;
+}
+
+
+static void shift_left(byte *x, size_t &size, size_t bits)
+// ----------------------------------------------------------------------------
+//   Shift a magnitude left in place, the caller ensures there is room
+// ----------------------------------------------------------------------------
+{
+    if (!size)
+        return;
+    size_t bytes = bits / 8;
+    uint   shift = bits % 8;
+    size_t len   = 8 * size - __builtin_clz(x[size - 1]) + 24 + bits;
+    size_t top   = (len + 7) / 8;
+    for (size_t i = top; i-- > bytes; )
+    {
+        size_t j = i - bytes;
+        uint   v = j < size ? x[j] << shift : 0;
+        if (shift && j > 0)
+            v |= x[j - 1] >> (8 - shift);
+        x[i] = byte(v);
+    }
+    for (size_t i = 0; i < bytes; i++)
+        x[i] = 0;
+    size = top;
+}
+
+
+static int compare(byte_p x, size_t xs, byte_p y, size_t ys)
+// ----------------------------------------------------------------------------
+//   Compare two magnitudes without leading zeros
+// ----------------------------------------------------------------------------
+{
+    if (xs != ys)
+        return xs < ys ? -1 : 1;
+    for (size_t i = xs; i-- > 0; )
+        if (x[i] != y[i])
+            return x[i] < y[i] ? -1 : 1;
+    return 0;
+}
+
+
+static void subtract(byte *x, size_t &xs, byte_p y, size_t ys)
+// ----------------------------------------------------------------------------
+//   Subtract y from x in place, with x >= y
+// ----------------------------------------------------------------------------
+{
+    uint borrow = 0;
+    for (size_t i = 0; i < xs; i++)
+    {
+        uint v = x[i] - (i < ys ? y[i] : 0) - borrow;
+        x[i] = byte(v);
+        borrow = (v >> 8) & 1;
+    }
+    while (xs > 0 && !x[xs - 1])
+        xs--;
+}
+
+
+static bignum_g gcd(bignum_r a, bignum_r b)
 // ----------------------------------------------------------------------------
 //   Compute the greatest common denominator between a and b
 // ----------------------------------------------------------------------------
+//   This runs the binary GCD in place on copies of the magnitudes in the
+//   scratchpad, and finishes with native 64-bit operations. This avoids
+//   the allocation and bit-serial division of each Euclid step.
 {
-    while (b && !b->is_zero())
+    if (!a || !b)
+        return nullptr;
+    size_t as = 0;
+    size_t bs = 0;
+    byte_p ap = a->value(&as);
+    byte_p bp = b->value(&bs);
+    if (as <= sizeof(ularge) && bs <= sizeof(ularge))
+        return bignum::make(gcd(a->value<ularge>(), b->value<ularge>()));
+    if (!as || !bs)
+    {
+        gcbytes src = as ? ap : bp;
+        return rt.make<bignum>(object::ID_bignum, src, as ? as : bs);
+    }
+
+    size_t needed = as + bs;
+    byte  *buffer = rt.allocate(needed);        // May GC here
+    if (!buffer)
+        return nullptr;
+    ap = a->value(&as);                         // Re-read after potential GC
+    bp = b->value(&bs);
+    byte *u = buffer;
+    byte *v = buffer + as;
+    memcpy(u, ap, as);
+    memcpy(v, bp, bs);
+
+    // Remove common factors of two, then make both odd
+    size_t uz    = trailing_zeros(u, as);
+    size_t vz    = trailing_zeros(v, bs);
+    size_t shift = std::min(uz, vz);
+    shift_right(u, as, uz);
+    shift_right(v, bs, vz);
+
+    // Subtract the smaller from the larger until both fit in 64 bits
+    int cmp = compare(u, as, v, bs);
+    while (cmp && (as > sizeof(ularge) || bs > sizeof(ularge)))
+    {
+        if (cmp < 0)
+        {
+            std::swap(u, v);
+            std::swap(as, bs);
+        }
+        subtract(u, as, v, bs);
+        shift_right(u, as, trailing_zeros(u, as));
+        cmp = compare(u, as, v, bs);
+    }
+    if (cmp)
     {
-        bignum_g na = b;
-        b = a % b;
-        a = na;
+        ularge uv = 0;
+        ularge vv = 0;
+        for (size_t i = 0; i < as; i++)
+            uv |= ularge(u[i]) << (8 * i);
+        for (size_t i = 0; i < bs; i++)
+            vv |= ularge(v[i]) << (8 * i);
+        uv = gcd(uv, vv);
+        for (as = 0; uv; uv >>= 8)
+            u[as++] = byte(uv);
     }
-    return a;
+
+    // The result divides both, so it fits in place with the factors of two
+    shift_left(u, as, shift);
+    gcbytes buf = u;
+    bignum_g result = rt.make<bignum>(object::ID_bignum, buf, as);
+    rt.free(needed);
+    return result;
 }
 
 
-fraction_g big_fraction::make(bignum_g n, bignum_g d)
+static inline bignum_g exact_div(bignum_r x, bignum_r cd)
+// ----------------------------------------------------------------------------
+//   Divide by a common divisor, skipping the division if it is 1
+// ----------------------------------------------------------------------------
+{
+    if (!x || !cd)
+        return nullptr;
+    return cd->is(1) ? x : x / cd;
+}
+
+
+fraction_g big_fraction::make(bignum_g n, bignum_g d, bool reduced)
 // ----------------------------------------------------------------------------
 //   Create a reduced fraction from n and d
 // ----------------------------------------------------------------------------
+//   If the caller knows that n and d are coprime, there is no GCD to compute
 {
-    bignum_g cd = gcd(n, d);
-    if (!cd)
+    if (!n || !d)
         return nullptr;
-    if (!cd->is(1))
+    if (!reduced || n->is_zero())
     {
-        n = n / cd;
-        d = d / cd;
+        bignum_g cd = gcd(n, d);
+        if (!cd)
+            return nullptr;
+        n = exact_div(n, cd);
+        d = exact_div(d, cd);
     }
     if (!n || !d)
         return nullptr;
@@ -347,6 +520,50 @@ fraction_g big_fraction::make(bignum_g n, bignum_g d)
 //
 // ============================================================================
 
+static fraction_g add_sub(bignum_r xn, bignum_r xd,
+                          bignum_r yn, bignum_r yd, bool sub)
+// ----------------------------------------------------------------------------
+//   Add or subtract reduced fractions, keeping the GCDs small
+// ----------------------------------------------------------------------------
+//   With g = gcd(xd, yd), the result is t / (xd/g * yd/g * g), where
+//   t = xn * yd/g ± yn * xd/g. Only gcd(t, g) can remain as a common
+//   factor, so there is no need for a GCD on the full result.
+{
+    bignum_g g  = gcd(xd, yd);
+    bignum_g xs = exact_div(xd, g);
+    bignum_g ys = exact_div(yd, g);
+    bignum_g xt = xn * ys;
+    bignum_g yt = yn * xs;
+    bignum_g t  = sub ? xt - yt : xt + yt;
+    if (!g || !t)
+        return nullptr;
+    if (g->is(1))
+        return big_fraction::make(t, xs * yd, true);
+    bignum_g g2 = gcd(t, g);
+    bignum_g n  = exact_div(t, g2);
+    bignum_g d  = exact_div(yd, g2);
+    return big_fraction::make(n, xs * d, true);
+}
+
+
+static fraction_g mul(bignum_r xn, bignum_r xd, bignum_r yn, bignum_r yd)
+// ----------------------------------------------------------------------------
+//   Multiply reduced fractions xn/xd and yn/yd
+// ----------------------------------------------------------------------------
+//   Removing gcd(xn, yd) and gcd(yn, xd) first leaves a reduced result
+{
+    bignum_g g1 = gcd(xn, yd);
+    bignum_g g2 = gcd(yn, xd);
+    bignum_g n1 = exact_div(xn, g1);
+    bignum_g d2 = exact_div(yd, g1);
+    bignum_g n2 = exact_div(yn, g2);
+    bignum_g d1 = exact_div(xd, g2);
+    if (!n1 || !n2 || !d1 || !d2)
+        return nullptr;
+    return big_fraction::make(n1 * n2, d1 * d2, true);
+}
+
+
 fraction_g operator-(fraction_r x)
 // ----------------------------------------------------------------------------
 //    Negation of a fraction
@@ -367,7 +584,7 @@ fraction_g operator+(fraction_r x, fraction_r y)
     bignum_g  xd = x->denominator();
     bignum_g  yn = y->numerator();
     bignum_g  yd = y->denominator();
-    return big_fraction::make(xn * yd + yn * xd, xd * yd);
+    return add_sub(xn, xd, yn, yd, false);
 }
 
 
@@ -380,7 +597,7 @@ fraction_g operator-(fraction_r x, fraction_r y)
     bignum_g  xd = x->denominator();
     bignum_g  yn = y->numerator();
     bignum_g  yd = y->denominator();
-    return big_fraction::make(xn * yd - yn * xd, xd * yd);
+    return add_sub(xn, xd, yn, yd, true);
 }
 
 
@@ -393,7 +610,7 @@ fraction_g operator*(fraction_r x, fraction_r y)
     bignum_g  xd = x->denominator();
     bignum_g  yn = y->numerator();
     bignum_g  yd = y->denominator();
-    return big_fraction::make(xn * yn, xd * yd);
+    return mul(xn, xd, yn, yd);
 }
 
 
@@ -406,7 +623,9 @@ fraction_g operator/(fraction_r x, fraction_r y)
     bignum_g  xd = x->denominator();
     bignum_g  yn = y->numerator();
     bignum_g  yd = y->denominator();
-    return big_fraction::make(xn * yd, xd * yn);
+    if (!yn || yn->is_zero())
+        return big_fraction::make(xn * yd, xd * yn);
+    return mul(xn, xd, yd, yn);
 }
 
 
@@ -143,7 +143,7 @@ struct big_fraction : fraction
             + d->size() - leb128size(d->type());
     }
 
-    static fraction_g make(bignum_g n, bignum_g d);
+    static fraction_g make(bignum_g n, bignum_g d, bool reduced = false);
 
     bignum_g numerator() const;
     bignum_g denominator() const;
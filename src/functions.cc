@@ -32,6 +32,7 @@
 #include "arithmetic.h"
 #include "array.h"
 #include "bignum.h"
+#include "compiled.h"
 #include "compare.h"
 #include "conditionals.h"
 #include "decimal.h"
@@ -42,6 +43,7 @@
 #include "list.h"
 #include "logical.h"
 #include "polynomial.h"
+#include "settings.h"
 #include "solve.h"
 #include "tag.h"
 #include "unit.h"
@@ -1215,6 +1217,77 @@ INSERT_BODY(cubed)
 }
 
 
+static algebraic_p product_range(ularge low, ularge high)
+// ----------------------------------------------------------------------------
+//   Product of the integers in [low, high], computed as a binary tree
+// ----------------------------------------------------------------------------
+//   Multiplying one factor at a time builds a growing bignum at each step,
+//   which is quadratic. Splitting the range in two keeps the operands of
+//   each multiplication balanced. Short ranges are multiplied in a machine
+//   word for as long as the product fits.
+{
+    if (low > high)
+        return integer::make(1);
+
+    // Each factor adds at least log2(low) bits, fail early if too big
+    uint lbits = 0;
+    for (ularge l = low; l > 1; l >>= 1)
+        lbits++;
+    if (lbits && high - low >= Settings.MaxNumberBits() / lbits)
+    {
+        rt.number_too_big_error();
+        return nullptr;
+    }
+
+    if (high - low < 16)
+    {
+        const ularge max = ~0ULL >> 1;
+        algebraic_g  result;
+        ularge       acc = 1;
+        for (ularge i = low; i <= high; i++)
+        {
+            if (acc > max / i)
+            {
+                algebraic_g factor = integer::make(acc);
+                result = result ? +(result * factor) : +factor;
+                if (!result)
+                    return nullptr;
+                acc = 1;
+            }
+            acc *= i;
+        }
+        algebraic_g factor = integer::make(acc);
+        return result ? +(result * factor) : +factor;
+    }
+
+    ularge      mid   = low + (high - low) / 2;
+    algebraic_g left  = product_range(low, mid);
+    if (!left || program::interrupted())
+        return nullptr;
+    algebraic_g right = product_range(mid + 1, high);
+    if (!right)
+        return nullptr;
+    return left * right;
+}
+
+
+static algebraic_p factorial(ularge n)
+// ----------------------------------------------------------------------------
+//   Compute the factorial of a integer value
+// ----------------------------------------------------------------------------
+{
+    const uint  small = integer::MAX_SMALL_FACTORIAL;
+    algebraic_g table = integer::make(integer::small_factorial(n < small
+                                                               ? n : small));
+    if (n <= small)
+        return table;
+    algebraic_g result = product_range(small + 1, n);
+    if (!result)
+        return nullptr;
+    return result * table;
+}
+
+
 FUNCTION_BODY(fact)
 // ----------------------------------------------------------------------------
 //   Perform factorial for integer values, fallback to gamma otherwise
@@ -1235,10 +1308,7 @@ FUNCTION_BODY(fact)
             rt.domain_error();
             return nullptr;
         }
-        algebraic_g result = integer::make(1);
-        for (uint i = 2; i <= max; i++)
-            result = result * integer::make(i);
-        return result;
+        return factorial(max);
     }
 
     if (x->is_decimal())
@@ -1279,11 +1349,16 @@ NFUNCTION_BODY(comb)
         {
             ularge ni = nval->value<ularge>();
             ularge mi = mval->value<ularge>();
-            n = integer::make(ni < mi ? 0 : 1);
-            for (ularge i = ni - mi + 1; i <= ni && n; i++)
-                n = n * algebraic_g(integer::make(i));
-            for (ularge i = 2; i <= mi && n; i++)
-                n = n / algebraic_g(integer::make(i));
+            if (ni < mi)
+                return integer::make(0);
+
+            // C(n, m) = C(n, n-m), use the smaller one
+            if (mi > ni - mi)
+                mi = ni - mi;
+            n = product_range(ni - mi + 1, ni);
+            m = n ? factorial(mi) : nullptr;
+            if (n && m)
+                n = n / m;
             return n;
         }
     }
@@ -1309,10 +1384,9 @@ NFUNCTION_BODY(perm)
         {
             ularge ni = nval->value<ularge>();
             ularge mi = mval->value<ularge>();
-            n = integer::make(ni < mi ? 0 : 1);
-            for (ularge i = ni - mi + 1; i <= ni && n; i++)
-                n = n * algebraic_g(integer::make(i));
-            return n;
+            if (ni < mi)
+                return integer::make(0);
+            return product_range(ni - mi + 1, ni);
         }
     }
 
@@ -1324,6 +1398,281 @@ NFUNCTION_BODY(perm)
 }
 
 
+enum
+{
+    SUM_MAX_DEGREE      = 8,    // Highest polynomial degree for closed forms
+    SUM_COMPILE_MIN     = 64,   // Number of terms to use compiled code
+};
+
+
+static bool sum_closed_terms(expression_r eq, symbol_r sym)
+// ----------------------------------------------------------------------------
+//   Check if eq only contains numbers, sym and basic arithmetic
+// ----------------------------------------------------------------------------
+//   Any other name may be a user function or a variable, and commands such
+//   as RAND are not deterministic, so evaluating a few terms is not enough.
+{
+    for (object_p obj : *eq)
+    {
+        object::id ty = obj->type();
+        switch(ty)
+        {
+        case object::ID_symbol:
+            if (!symbol_p(obj)->is_same_as(sym))
+                return false;
+            break;
+        case object::ID_add:
+        case object::ID_sub:
+        case object::ID_mul:
+        case object::ID_div:
+        case object::ID_pow:
+            break;
+        default:
+            if (!object::is_real(ty))
+                return false;
+            break;
+        }
+    }
+    return true;
+}
+
+
+static int sum_degree(expression_r eq, symbol_r sym)
+// ----------------------------------------------------------------------------
+//   Return the degree of a polynomial in sym, or -1 if not a polynomial
+// ----------------------------------------------------------------------------
+{
+    if (!eq->depends_on(sym))
+        return 0;
+
+    object_p op = eq->outermost_operator();
+    if (!op)
+        return -1;
+
+    object::id   ty = op->type();
+    expression_g l, r;
+    switch(ty)
+    {
+    case object::ID_symbol:
+        return symbol_p(op)->is_same_as(sym) ? 1 : -1;
+
+    case object::ID_add:
+    case object::ID_sub:
+    case object::ID_mul:
+    {
+        if (!eq->split(ty, l, r))
+            return -1;
+        int dl = sum_degree(l, sym);
+        int dr = sum_degree(r, sym);
+        if (dl < 0 || dr < 0)
+            return -1;
+        if (ty == object::ID_mul)
+            return dl + dr;
+        return dl > dr ? dl : dr;
+    }
+
+    case object::ID_div:
+        if (!eq->split(ty, l, r) || r->depends_on(sym))
+            return -1;
+        return sum_degree(l, sym);
+
+    case object::ID_pow:
+    {
+        if (!eq->split(ty, l, r) || r->depends_on(sym))
+            return -1;
+        int dl = sum_degree(l, sym);
+        if (dl < 0)
+            return -1;
+        algebraic_g exponent = r->evaluate();
+        if (!exponent || exponent->type() != object::ID_integer)
+            return -1;
+        uint k = exponent->as_uint32(0, false);
+        if (k > SUM_MAX_DEGREE)
+            return -1;
+        return dl * k;
+    }
+
+    default:
+        return -1;
+    }
+}
+
+
+static bool sum_geometric(expression_r eq, symbol_r sym, algebraic_g &ratio)
+// ----------------------------------------------------------------------------
+//   Check if eq has the form C*R^(A*sym+B), and if so return R^A
+// ----------------------------------------------------------------------------
+{
+    if (!eq->depends_on(sym))
+    {
+        ratio = integer::make(1);
+        return +ratio;
+    }
+
+    object_p op = eq->outermost_operator();
+    if (!op)
+        return false;
+
+    object::id   ty = op->type();
+    expression_g l, r;
+    switch(ty)
+    {
+    case object::ID_mul:
+    case object::ID_div:
+    {
+        algebraic_g rl, rr;
+        if (!eq->split(ty, l, r) ||
+            !sum_geometric(l, sym, rl) || !sum_geometric(r, sym, rr))
+            return false;
+        ratio = ty == object::ID_mul ? rl * rr : rl / rr;
+        return +ratio;
+    }
+
+    case object::ID_pow:
+    {
+        algebraic_g a, b;
+        if (!eq->split(ty, l, r) || l->depends_on(sym) ||
+            !r->is_linear(sym, a, b))
+            return false;
+        algebraic_g base = l->evaluate();
+        if (!base)
+            return false;
+        ratio = pow(base, a);
+        return +ratio;
+    }
+
+    default:
+        return false;
+    }
+}
+
+
+static algebraic_p sum_closed_form(bool product, program_r prg, symbol_r sym,
+                                   large first, large count)
+// ----------------------------------------------------------------------------
+//   Sum or product of polynomial or geometric terms without a loop
+// ----------------------------------------------------------------------------
+//   A polynomial of degree d is summed with Newton's forward formula,
+//     sum(f(a+i), i=0..n-1) = sum(C(n,k+1) * D^k f(a), k=0..d)
+//   which only needs d+1 evaluations, and is exact for exact values.
+//   Geometric terms use the usual f(a) * (r^n - 1) / (r - 1).
+//   Symbolic terms are left to the loop, which keeps each term visible.
+{
+    expression_g eq = prg->as<expression>();
+    if (!eq || count < 2 || count >= (1LL << 31) || !sum_closed_terms(eq, sym))
+        return nullptr;
+
+    if (!product)
+    {
+        int degree = sum_degree(eq, sym);
+        if (degree >= 0 && degree <= SUM_MAX_DEGREE && count > degree + 1)
+        {
+            algebraic_g diffs[SUM_MAX_DEGREE + 1];
+            for (int k = 0; k <= degree; k++)
+            {
+                algebraic_g x = integer::make(first + k);
+                diffs[k] = algebraic::evaluate_function(prg, x);
+                if (!diffs[k] || !diffs[k]->is_algebraic_number())
+                    return nullptr;
+            }
+            for (int k = 1; k <= degree; k++)
+                for (int j = degree; j >= k; j--)
+                    diffs[j] = diffs[j] - diffs[j - 1];
+
+            algebraic_g binom = integer::make(count);
+            algebraic_g sum   = integer::make(0);
+            for (int k = 0; k <= degree && sum; k++)
+            {
+                sum = sum + binom * diffs[k];
+                binom = binom * algebraic_g(integer::make(count - k - 1))
+                    / algebraic_g(integer::make(k + 2));
+            }
+            return sum;
+        }
+    }
+
+    algebraic_g ratio;
+    if (rt.error() || !sum_geometric(eq, sym, ratio) ||
+        !ratio || !ratio->is_algebraic_number())
+        return nullptr;
+
+    algebraic_g x    = integer::make(first);
+    algebraic_g term = algebraic::evaluate_function(prg, x);
+    if (!term || !term->is_algebraic_number())
+        return nullptr;
+    algebraic_g n = integer::make(count);
+    if (product)
+        return pow(term, n) * pow(ratio, ularge(count * (count - 1) / 2));
+    if (ratio->is_one(false))
+        return term * n;
+    algebraic_g one = integer::make(1);
+    return term * (pow(ratio, ularge(count)) - one) / (ratio - one);
+}
+
+
+static inline bool sum_inexact(algebraic_r x)
+// ----------------------------------------------------------------------------
+//   Check if a value is subject to rounding when added
+// ----------------------------------------------------------------------------
+{
+    object::id ty = x->type();
+    return object::is_decimal(ty) ||
+        ty == object::ID_hwfloat || ty == object::ID_hwdouble;
+}
+
+
+static algebraic_p sum_terms(bool product, program_r prg,
+                             algebraic_g x, large count)
+// ----------------------------------------------------------------------------
+//   Sum or multiply the values of prg for x, x+1, ... x+count-1
+// ----------------------------------------------------------------------------
+//   Inexact sums use Kahan compensated summation, and large inexact sums
+//   are evaluated in batches with compiled code when possible.
+{
+    algebraic_g one    = integer::make(1);
+    algebraic_g result = integer::make(product ? 1 : 0);
+    algebraic_g carry;
+    for (large i = 0; i < count && result; i++)
+    {
+        if (program::interrupted())
+            return nullptr;
+        algebraic_g term = algebraic::evaluate_function(prg, x);
+        if (!term)
+            return nullptr;
+
+        if (product)
+        {
+            result = result * term;
+        }
+        else if (sum_inexact(term) && sum_inexact(result))
+        {
+            if (carry)
+                term = term - carry;
+            algebraic_g total = result + term;
+            carry = (total - result) - term;
+            result = total;
+        }
+        else
+        {
+            result = result + term;
+        }
+        x = x + one;
+
+        if (!product && i == 0 && sum_inexact(term) &&
+            count > SUM_COMPILE_MIN && count <= large(~0U))
+        {
+            compiled_function code(prg, Settings.Precision());
+            if (code.compiled())
+                if (algebraic_g rest = code.sum(x, one, uint(count - 1)))
+                    return result + rest;
+        }
+    }
+    if (carry && result)
+        result = result - carry;
+    return result;
+}
+
+
 static algebraic_p sum_product(object::id op,
                                algebraic_g args[], uint arity)
 // ----------------------------------------------------------------------------
@@ -1352,59 +1701,32 @@ static algebraic_p sum_product(object::id op,
         return nullptr;
     }
 
+    bool product = op == object::ID_mul;
     if (init->is_integer() && last->is_integer())
     {
         program_g        prg  = program_p(+expr);
         large            a    = init->as_int64(0, false);
         large            b    = last->as_int64(0, false);
+        large            n    = b >= a ? b - a + 1 : 0;
         save<symbol_g *> iref(expression::independent, &name);
 
-        if (op == object::ID_mul)
-        {
-            init = integer::make(1);
-            for (large i = a; i <= b && init; i++)
-            {
-                last = integer::make(i);
-                last = algebraic::evaluate_function(prg, last);
-                if (!last || program::interrupted())
-                    return nullptr;
-                init = init * last;
-            }
-        }
-        else
-        {
-            init = integer::make(0);
-            for (large i = a; i <= b && init; i++)
-            {
-                last = integer::make(i);
-                last = algebraic::evaluate_function(prg, last);
-                if (!last || program::interrupted())
-                    return nullptr;
-                init = init + last;
-            }
-        }
-        return init;
+        if (algebraic_p closed = sum_closed_form(product, prg, name, a, n))
+            return closed;
+        if (rt.error())
+            return nullptr;
+        return sum_terms(product, prg, init, n);
     }
     else if (init->is_real() && last->is_real())
     {
         program_g        prg  = program_p(+expr);
         save<symbol_g *> iref(expression::independent, &name);
-        bool             product = op == object::ID_mul;
-        algebraic_g      result  = integer::make(product ? 1 : 0);
-        algebraic_g      one     = integer::make(1);
-        while (!program::interrupted())
-        {
-            algebraic_g tmp = (init > last);
-            if (!tmp || tmp->as_truth(false))
-                break;
-
-            tmp = algebraic::evaluate_function(prg, init);
-            if (!tmp)
-                return nullptr;
-            result = product ? result * tmp : result + tmp;
-            init = init + one;
-        }
-        return result;
+        algebraic_g      diff = last - init;
+        if (!diff)
+            return nullptr;
+        large            n    = diff->is_negative(false)
+            ? 0
+            : diff->as_int64(0, false) + 1;
+        return sum_terms(product, prg, init, n);
     }
     else
     {
@@ -361,10 +361,9 @@ PARSE_BODY(integer)
         bignum_g bresult = nullptr;
         if (big)
         {
-            // We may cause garbage collection in bignum arithmetic
+            // We may cause garbage collection when allocating the buffer
             gcbytes gs    = s;
             gcbytes ge    = endp;
-            size_t  count = endp - s;
 
             switch (type)
             {
@@ -380,37 +379,99 @@ PARSE_BODY(integer)
             default: break;
             }
 
-            // Integrate last digit that overflowed above
-            bignum_g bbase  = rt.make<bignum>(ID_bignum, base);
-            bignum_g bvalue = rt.make<bignum>(type, v);
-            bresult         = rt.make<bignum>(type, result);
-            bresult = bvalue + bbase * bresult; // Order matters for types
-
-            while (count--)
+            // Find the remaining digits, without causing garbage collection
+            byte_p end       = endp ? endp : last;
+            byte_p stop      = s;
+            size_t remaining = 0;
+            while (stop < end)
             {
-                v = value[*gs];
-                ++gs;
-                if (v == NODIGIT)
+                if (utf8_codepoint(stop) == sep)
+                {
+                    stop = utf8_next(stop);
+                    continue;
+                }
+                byte d = value[*stop];
+                if (d == NODIGIT)
                     break;
-
-                if (v >= base)
+                if (d >= base)
                 {
                     object::result err = ERROR;
                     if (type == ID_bignum || type == ID_neg_bignum)
                     {
-                        if (v == 0xE) // Exponent, switch to decimal
+                        if (d == 0xE) // Exponent, switch to decimal
                             err = WARN;
                         else
                             break;
                     }
-                    rt.based_digit_error().source(s - 1);
+                    rt.based_digit_error().source(stop);
                     return err;
                 }
-                record(integer, "Digit %c value %u in bignum", s[-1], v);
-                bvalue  = rt.make<bignum>(type, v);
-                bresult = bvalue + bbase * bresult;
+                stop++;
+                remaining++;
             }
+            size_t span = stop - s;
+            size_t next = (endp && stop == endp) ? span : span + 1;
+
+            // Size the buffer from the number of digits and the word size
+            uint   bits = 1;
+            while ((1U << bits) < uint(base))
+                bits++;
+            size_t wbits  = bignum::wordsize(type);
+            size_t wbytes = (wbits + 7) / 8;
+            size_t needed = sizeof(result) + 1 + (remaining * bits + 7) / 8;
+            if (wbits && needed > wbytes)
+                needed = wbytes;
+            byte *buffer = rt.allocate(needed);         // May GC here
+            if (!buffer)
+                return ERROR;
+            s = gs;
 
+            // Integrate the value so far and the last digit that overflowed
+            size_t size = 0;
+            for (ularge hi = result; hi && size < needed; hi >>= 8)
+                buffer[size++] = byte(hi);
+            size = bignum::mul_add(buffer, size, needed, base, v);
+
+            // Integrate the other digits several at a time
+            uint   chunk = bignum::chunk_power(base);
+            uint   power = 1;
+            uint   acc   = 0;
+            for (byte_p d = s; d < s + span; )
+            {
+                if (utf8_codepoint(d) == sep)
+                {
+                    d = utf8_next(d);
+                    continue;
+                }
+                acc = acc * base + value[*d++];
+                power *= base;
+                if (power == chunk)
+                {
+                    size = bignum::mul_add(buffer, size, needed, power, acc);
+                    power = 1;
+                    acc = 0;
+                }
+            }
+            if (power > 1)
+                size = bignum::mul_add(buffer, size, needed, power, acc);
+
+            // Truncate to the word size, e.g. 12 bits
+            if (size == wbytes && (wbits % 8))
+                buffer[size - 1] &= byte(0xFFu >> (8 - wbits % 8));
+            while (size > 0 && buffer[size - 1] == 0)
+                size--;
+            if (!wbits && size * 8 > Settings.MaxNumberBits())
+            {
+                rt.free(needed);
+                rt.number_too_big_error();
+                return ERROR;
+            }
+            gcbytes buf = buffer;
+            bresult = rt.make<bignum>(type, buf, size);
+            rt.free(needed);
+            if (!bresult)
+                return ERROR;
+            gs = s + next;
             s    = gs;
             endp = ge;
         }
@@ -587,6 +648,39 @@ PARSE_BODY(integer)
 }
 
 
+ularge integer::small_factorial(uint n)
+// ----------------------------------------------------------------------------
+//   Return the factorial of small values from a table
+// ----------------------------------------------------------------------------
+{
+    static const ularge factorials[MAX_SMALL_FACTORIAL + 1] =
+    {
+        1ULL,
+        1ULL,
+        2ULL,
+        6ULL,
+        24ULL,
+        120ULL,
+        720ULL,
+        5040ULL,
+        40320ULL,
+        362880ULL,
+        3628800ULL,
+        39916800ULL,
+        479001600ULL,
+        6227020800ULL,
+        87178291200ULL,
+        1307674368000ULL,
+        20922789888000ULL,
+        355687428096000ULL,
+        6402373705728000ULL,
+        121645100408832000ULL,
+        2432902008176640000ULL,
+    };
+    return n <= MAX_SMALL_FACTORIAL ? factorials[n] : 0;
+}
+
+
 static size_t render_num(renderer &r,
                          integer_p num,
                          uint      base,
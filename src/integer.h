@@ -117,6 +117,10 @@ struct integer : algebraic
     static bool native(byte_p x)        { return leb128size(x) <= NATIVE; }
     bool native() const                 { return native(payload(this)); }
 
+    // Factorials up to 20! fit in 63 bits and come from a table
+    enum { MAX_SMALL_FACTORIAL = 20 };
+    static ularge small_factorial(uint n);
+
 public:
     OBJECT_DECL(integer);
     PARSE_DECL(integer);
@@ -31,11 +31,14 @@
 
 #include "algebraic.h"
 #include "arithmetic.h"
+#include "array.h"
 #include "compare.h"
+#include "compiled.h"
 #include "equations.h"
 #include "expression.h"
 #include "functions.h"
 #include "integer.h"
+#include "parser.h"
 #include "recorder.h"
 #include "settings.h"
 #include "symbol.h"
@@ -96,43 +99,66 @@ NFUNCTION_BODY(Integrate)
 }
 
 
-algebraic_p integrate(program_g   eq,
-                      symbol_g    name,
-                      algebraic_g lx,
-                      algebraic_g hx)
+uint Integrate::evaluations = 0;
+uint Integrate::iterations  = 0;
+
+
+COMMAND_BODY(IntegrationStatistics)
+// ----------------------------------------------------------------------------
+//   Return the number of evaluations and iterations of the last integration
+// ----------------------------------------------------------------------------
+{
+    tag_g ev = tag::make("Evaluations", integer::make(Integrate::evaluations));
+    tag_g it = tag::make("Iterations",  integer::make(Integrate::iterations));
+    if (ev && it)
+    {
+        scribble scr;
+        if (rt.append(ev) && rt.append(it))
+        {
+            size_t  sz   = scr.growth();
+            gcbytes data = scr.scratch();
+            if (array_p a = rt.make<array>(ID_array, data, sz))
+                if (rt.push(a))
+                    return OK;
+        }
+    }
+    return ERROR;
+}
+
+
+static inline algebraic_p sample(const compiled_function &fn, algebraic_r x)
+// ----------------------------------------------------------------------------
+//   Evaluate the function to integrate, counting evaluations
+// ----------------------------------------------------------------------------
+{
+    Integrate::evaluations++;
+    return fn.evaluate(x);
+}
+
+
+static algebraic_p romberg(const compiled_function &fn,
+                           algebraic_r              lx,
+                           algebraic_r              hx,
+                           algebraic_r              eps)
 // ----------------------------------------------------------------------------
-//   Romberg algorithm - The core of the integration function
+//   Romberg algorithm
 // ----------------------------------------------------------------------------
 //   The Romberg algorithm uses two buffers, one keeping the approximations
 //   from the previous loop, called P, and one for the current loop, called C.
 //   At each step, the size of C is one more than P.
 //   In the implementation below, those arrays are on the stack, P above C.
 {
-    // We will run commands below, do not save stack while doing it
-    settings::PrepareForProgramEvaluation wilLRunPrograms;
-
-    // Check if the guess is an algebraic or if we need to extract one
     algebraic_g x, dx, dx2;
     algebraic_g y, dy, sy, sy2;
     algebraic_g one  = integer::make(1);
     algebraic_g two  = integer::make(2);
     algebraic_g four = integer::make(4);
     algebraic_g pow4;
-    record(integrate, "Initial range %t-%t", +lx, +hx);
-
-    // Set independent variable
-    save<symbol_g *> iref(expression::independent, &name);
-    int              prec = (Settings.Precision() -
-                             Settings.IntegrationImprecision());
-    algebraic_g      eps = decimal::make(1, -prec);
-
-    // Select numerical computations (doing this with fraction is slow)
-    settings::SaveNumericalResults snr(true);
 
     // Initial integration step and first trapezoidal step
     dx              = hx - lx;
-    sy              = algebraic::evaluate_function(eq, lx);
-    sy2             = algebraic::evaluate_function(eq, hx);
+    sy              = sample(fn, lx);
+    sy2             = sample(fn, hx);
     sy              = (sy + sy2) * dx / two;
     if (!dx || !sy)
         return nullptr;
@@ -148,29 +174,40 @@ algebraic_p integrate(program_g   eq,
 
     for (uint d = 0; d < max && !program::interrupted(); d++)
     {
+        Integrate::iterations++;
         dx2 = dx / two;
         sy  = integer::make(0);
         x   = lx + dx2;
         if (!x || !sy || !dx)
             goto error;
 
-        // Compute the sum of f(low + k*i)
-        for (uint i = 0; i < loops; i++)
+        // Compute the sum of f(low + k*i), as a single batch if compiled
+        if (algebraic_p batch = fn.sum(x, dx, loops))
         {
-            if (!algebraic::to_decimal_if_big(x))
-                goto error;
-
-            // Evaluate equation
-            y  = algebraic::evaluate_function(eq, x);
-
-            // Sum elements, and approximate when necessary
-            sy = sy + y;
-            if (!algebraic::to_decimal_if_big(sy))
-                goto error;
-            record(integrate, "[%u:%u] x=%t y=%t sum=%t", d, i, +x, +y, +sy);
-            x = x + dx;
-            if (!sy || !x)
-                goto error;
+            sy = batch;
+            Integrate::evaluations += loops;
+            record(integrate, "[%u] batch of %u sum=%t", d, loops, +sy);
+        }
+        else
+        {
+            for (uint i = 0; i < loops; i++)
+            {
+                if (!algebraic::to_decimal_if_big(x))
+                    goto error;
+
+                // Evaluate equation
+                y  = sample(fn, x);
+
+                // Sum elements, and approximate when necessary
+                sy = sy + y;
+                if (!algebraic::to_decimal_if_big(sy))
+                    goto error;
+                record(integrate, "[%u:%u] x=%t y=%t sum=%t",
+                       d, i, +x, +y, +sy);
+                x = x + dx;
+                if (!sy || !x)
+                    goto error;
+            }
         }
 
         // Get P[0]
@@ -240,3 +277,440 @@ error:
     rt.drop(rt.depth() - depth);
     return nullptr;
 }
+
+
+// ============================================================================
+//
+//   Adaptive Gauss-Kronrod integration
+//
+// ============================================================================
+//   The 15-point Kronrod rule reuses the 7 points of the Gauss rule, and the
+//   difference between the two gives an error estimate for each interval.
+//   The interval with the largest error is split until the total error
+//   estimate is small enough. The values are from QUADPACK (dqk15).
+
+static cstring gk15_nodes[] =
+// ----------------------------------------------------------------------------
+//   Abscissae of the 15-point Kronrod rule, odd ones are the Gauss nodes
+// ----------------------------------------------------------------------------
+{
+    "0.991455371120812639206854697526329",
+    "0.949107912342758524526189684047851",
+    "0.864864423359769072789712788640926",
+    "0.741531185599394439863864773280788",
+    "0.586087235467691130294144845693013",
+    "0.405845151377397166906606412076961",
+    "0.207784955007898467600689403773245",
+    "0",
+};
+
+
+static cstring gk15_weights[] =
+// ----------------------------------------------------------------------------
+//   Weights of the 15-point Kronrod rule
+// ----------------------------------------------------------------------------
+{
+    "0.022935322010529224963732008058970",
+    "0.063092092629978553290700663189204",
+    "0.104790010322250183839876322541518",
+    "0.140653259715525918745189590510238",
+    "0.169004726639267902826583426598550",
+    "0.190350578064785409913256402421014",
+    "0.204432940075298892414161999234649",
+    "0.209482141084727828012999174891714",
+};
+
+
+static cstring g7_weights[] =
+// ----------------------------------------------------------------------------
+//   Weights of the 7-point Gauss rule
+// ----------------------------------------------------------------------------
+{
+    "0.129484966168869693270611432679082",
+    "0.279705391489276667901467771423780",
+    "0.381830050505118944950369775488975",
+    "0.417959183673469387755102040816327",
+};
+
+
+static algebraic_p gk_constant(cstring value)
+// ----------------------------------------------------------------------------
+//   Parse one of the constants above
+// ----------------------------------------------------------------------------
+{
+    parser p(utf8(value), strlen(value));
+    if (decimal::do_parse(p) != object::OK)
+        return nullptr;
+    return algebraic_p(+p.out);
+}
+
+
+struct gauss_kronrod_rule
+// ----------------------------------------------------------------------------
+//   The nodes and weights, parsed once per integration
+// ----------------------------------------------------------------------------
+{
+    gauss_kronrod_rule()
+    {
+        for (uint i = 0; i < 8; i++)
+        {
+            xgk[i] = gk_constant(gk15_nodes[i]);
+            wgk[i] = gk_constant(gk15_weights[i]);
+        }
+        for (uint i = 0; i < 4; i++)
+            wg[i] = gk_constant(g7_weights[i]);
+    }
+
+    bool valid() const
+    {
+        for (uint i = 0; i < 8; i++)
+            if (!xgk[i] || !wgk[i])
+                return false;
+        for (uint i = 0; i < 4; i++)
+            if (!wg[i])
+                return false;
+        return true;
+    }
+
+    algebraic_g xgk[8], wgk[8], wg[4];
+};
+
+
+static bool gauss_kronrod(const compiled_function  &fn,
+                          const gauss_kronrod_rule &rule,
+                          algebraic_r               lx,
+                          algebraic_r               hx,
+                          algebraic_g              &value,
+                          algebraic_g              &error)
+// ----------------------------------------------------------------------------
+//   Apply the G7/K15 rule on a single interval
+// ----------------------------------------------------------------------------
+{
+    algebraic_g two = integer::make(2);
+    algebraic_g c   = (lx + hx) / two;
+    algebraic_g h   = (hx - lx) / two;
+    algebraic_g fc  = sample(fn, c);
+    if (!fc)
+        return false;
+
+    algebraic_g rk  = fc * rule.wgk[7];
+    algebraic_g rg  = fc * rule.wg[3];
+    algebraic_g dx, x, f1, f2;
+    for (uint j = 0; j < 7; j++)
+    {
+        dx = h * rule.xgk[j];
+        x  = c - dx;
+        f1 = sample(fn, x);
+        x  = c + dx;
+        f2 = sample(fn, x);
+        if (!f1 || !f2)
+            return false;
+        f1 = f1 + f2;
+        rk = rk + rule.wgk[j] * f1;
+        if (j & 1)
+            rg = rg + rule.wg[j / 2] * f1;
+        if (!rk || !rg || !algebraic::to_decimal_if_big(rk))
+            return false;
+    }
+
+    value = rk * h;
+    error = abs::run(value - rg * h);
+    return value && error;
+}
+
+
+static algebraic_p gauss_kronrod(const compiled_function &fn,
+                                 algebraic_r              lx,
+                                 algebraic_r              hx,
+                                 algebraic_r              eps)
+// ----------------------------------------------------------------------------
+//   Adaptive Gauss-Kronrod integration
+// ----------------------------------------------------------------------------
+//   Intervals are kept on the stack as groups of four items: low and high
+//   bounds, value and error estimate. The queue is small, so the interval
+//   with the largest error is found with a linear scan.
+{
+    gauss_kronrod_rule rule;
+    if (!rule.valid())
+        return nullptr;
+
+    algebraic_g value, error, total, terror, low, high, mid;
+    algebraic_g two = integer::make(2);
+    size_t      depth = rt.depth();
+    uint        count = 1;
+    uint        max   = 4 * Settings.IntegrationIterations();
+
+    if (!gauss_kronrod(fn, rule, lx, hx, total, terror))
+        return nullptr;
+    if (!rt.push(+lx) || !rt.push(+hx) || !rt.push(+total) ||
+        !rt.push(+terror))
+        goto error;
+
+    while (!program::interrupted())
+    {
+        record(integrate, "Gauss-Kronrod %u intervals value=%t error=%t",
+               count, +total, +terror);
+        if (terror->is_zero() || smaller_magnitude(terror, total * eps))
+        {
+            rt.drop(rt.depth() - depth);
+            return total;
+        }
+        if (count >= max)
+            break;
+
+        // Find the interval with the largest error
+        uint worst = 0;
+        error = algebraic_p(rt.stack(0));
+        for (uint i = 1; i < count; i++)
+        {
+            value = algebraic_p(rt.stack(4 * i));
+            if (smaller_magnitude(error, value))
+            {
+                error = value;
+                worst = i;
+            }
+        }
+
+        // Split it in two
+        uint base = 4 * worst;
+        low    = algebraic_p(rt.stack(base + 3));
+        high   = algebraic_p(rt.stack(base + 2));
+        mid    = (low + high) / two;
+        if (!mid)
+            goto error;
+
+        if (!gauss_kronrod(fn, rule, low, mid, value, error))
+            goto error;
+        if (!rt.stack(base + 2, +mid) ||
+            !rt.stack(base + 1, +value) ||
+            !rt.stack(base + 0, +error))
+            goto error;
+
+        if (!gauss_kronrod(fn, rule, mid, high, value, error))
+            goto error;
+        if (!rt.push(+mid) || !rt.push(+high) ||
+            !rt.push(+value) || !rt.push(+error))
+            goto error;
+        count++;
+        Integrate::iterations++;
+
+        // Sum the intervals again rather than subtract and add the changes,
+        // which would accumulate rounding errors in the totals
+        total  = algebraic_p(rt.stack(1));
+        terror = algebraic_p(rt.stack(0));
+        for (uint i = 1; i < count && total && terror; i++)
+        {
+            value  = algebraic_p(rt.stack(4 * i + 1));
+            error  = algebraic_p(rt.stack(4 * i + 0));
+            total  = total + value;
+            terror = terror + error;
+        }
+        if (!total || !terror)
+            goto error;
+    }
+
+    rt.precision_loss_error();
+
+error:
+    rt.drop(rt.depth() - depth);
+    return nullptr;
+}
+
+
+
+// ============================================================================
+//
+//   Double exponential (tanh-sinh) integration
+//
+// ============================================================================
+//   The substitution x = c + h * tanh(pi/2 * sinh(t)) makes the integrand
+//   decay double-exponentially at both ends, which deals well with
+//   singularities at the endpoints. Each level halves the step in t and
+//   only evaluates the new points, reusing the sum of the previous levels.
+
+static bool tanh_sinh(const compiled_function &fn,
+                      algebraic_r              lx,
+                      algebraic_r              hx,
+                      algebraic_r              h,
+                      algebraic_r              hpi,
+                      algebraic_r              t,
+                      algebraic_g             &term)
+// ----------------------------------------------------------------------------
+//   Compute the contribution of the two points at t and -t
+// ----------------------------------------------------------------------------
+//   Returns false once the points are too close to the ends to be computed
+{
+    algebraic_g one = integer::make(1);
+    algebraic_g two = integer::make(2);
+    algebraic_g et  = exp::run(t);
+    algebraic_g iet = one / et;
+    algebraic_g st  = (et - iet) / two;
+    algebraic_g ct  = (et + iet) / two;
+    algebraic_g u   = hpi * st;
+    algebraic_g eu  = exp::run(u);
+    algebraic_g cu  = (eu + one / eu) / two;
+    if (!cu)
+        return false;
+
+    // Distance to the ends, computed accurately even when very small
+    algebraic_g d  = h / (eu * cu);
+    algebraic_g x1 = lx + d;
+    algebraic_g x2 = hx - d;
+    algebraic_g d1 = x1 - lx;
+    algebraic_g d2 = hx - x2;
+    if (!d1 || !d2)
+        return false;
+
+    // A point that rounds to its end has a negligible weight, unless the
+    // function is singular there, in which case we can't evaluate it anyway.
+    // Each end is checked separately, the other one may still contribute.
+    bool in1 = !d1->is_zero();
+    bool in2 = !d2->is_zero();
+    if (!in1 && !in2)
+        return false;
+
+    algebraic_g w  = hpi * ct / (cu * cu);
+    algebraic_g f1 = in1 ? sample(fn, x1) : integer::make(0);
+    algebraic_g f2 = !f1 ? nullptr : in2 ? sample(fn, x2) : integer::make(0);
+    if (!f1 || !f2)
+        return false;
+    term = w * (f1 + f2);
+    return term;
+}
+
+
+static algebraic_p tanh_sinh(const compiled_function &fn,
+                             algebraic_r              lx,
+                             algebraic_r              hx,
+                             algebraic_r              eps)
+// ----------------------------------------------------------------------------
+//   Double exponential integration
+// ----------------------------------------------------------------------------
+{
+    algebraic_g one  = integer::make(1);
+    algebraic_g two  = integer::make(2);
+    algebraic_g hpi  = algebraic::pi() / two;
+    algebraic_g c    = (lx + hx) / two;
+    algebraic_g h    = (hx - lx) / two;
+    algebraic_g eps2 = eps * eps;
+    algebraic_g sum, term, step, t, result, last;
+
+    // Level 0: t = 0, then integer values of t until terms are negligible
+    sum = sample(fn, c);
+    sum = sum * hpi;
+    if (!sum)
+        return nullptr;
+
+    // Points beyond tmax are negligible or too close to the ends
+    uint tmax = 0;
+    for (uint k = 1; k <= 6; k++)
+    {
+        tmax = k;
+        t = integer::make(k);
+        if (!tanh_sinh(fn, lx, hx, h, hpi, t, term))
+        {
+            if (rt.error())
+                return nullptr;
+
+            // If even t=1 is too close to the ends, the center is no estimate
+            if (k == 1)
+            {
+                rt.precision_loss_error();
+                return nullptr;
+            }
+            break;
+        }
+        sum = sum + term;
+        if (!sum)
+            return nullptr;
+        if (term->is_zero() || smaller_magnitude(term, sum * eps2))
+            break;
+    }
+    step = one;
+    last = sum * h;
+    if (!last)
+        return nullptr;
+
+    // Refine by halving the step, only computing odd multiples of the step
+    uint max = Settings.IntegrationIterations();
+    uint n   = tmax;
+    for (uint level = 1; level <= max && !program::interrupted(); level++)
+    {
+        Integrate::iterations++;
+        step = step / two;
+        n += n;
+        for (uint k = 1; k < n; k += 2)
+        {
+            t = integer::make(k) * step;
+            if (!tanh_sinh(fn, lx, hx, h, hpi, t, term))
+            {
+                if (rt.error())
+                    return nullptr;
+                break;
+            }
+            sum = sum + term;
+            if (!sum || !algebraic::to_decimal_if_big(sum))
+                return nullptr;
+        }
+
+        result = sum * h * step;
+        record(integrate, "Tanh-sinh level %u step %t value %t",
+               level, +step, +result);
+        if (!result)
+            return nullptr;
+        algebraic_g diff = result - last;
+        if (!diff)
+            return nullptr;
+        if (diff->is_zero() || smaller_magnitude(diff, result * eps))
+            return result;
+        last = result;
+    }
+
+    rt.precision_loss_error();
+    return nullptr;
+}
+
+
+algebraic_p integrate(program_g   eq,
+                      symbol_g    name,
+                      algebraic_g lx,
+                      algebraic_g hx)
+// ----------------------------------------------------------------------------
+//   The core of the integration function, select the integration method
+// ----------------------------------------------------------------------------
+{
+    // We will run commands below, do not save stack while doing it
+    settings::PrepareForProgramEvaluation wilLRunPrograms;
+    record(integrate, "Initial range %t-%t", +lx, +hx);
+
+    // Set independent variable
+    save<symbol_g *> iref(expression::independent, &name);
+    int              prec = (Settings.Precision() -
+                             Settings.IntegrationImprecision());
+    algebraic_g      eps = decimal::make(1, -prec);
+
+    // Select numerical computations (doing this with fraction is slow)
+    settings::SaveNumericalResults snr(true);
+
+    // Use hardware floating-point code if it is precise enough
+    compiled_function fn(eq, Settings.Precision());
+
+    algebraic_p result = nullptr;
+    Integrate::evaluations = 0;
+    Integrate::iterations  = 0;
+    switch(Settings.IntegrationMethod())
+    {
+    case object::ID_GaussKronrodIntegration:
+        result = gauss_kronrod(fn, lx, hx, eps);
+        break;
+    case object::ID_TanhSinhIntegration:
+        result = tanh_sinh(fn, lx, hx, eps);
+        break;
+    default:
+        result = romberg(fn, lx, hx, eps);
+        break;
+    }
+    record(integrate, "Result %t after %u evaluations in %u iterations",
+           result, Integrate::evaluations, Integrate::iterations);
+    return result;
+}
@@ -43,6 +43,9 @@ NFUNCTION(Integrate, 4,
           {
               return a == 0 || a == 1;
           }
+          static uint evaluations;
+          static uint iterations;
     );
+COMMAND_DECLARE(IntegrationStatistics, 0);
 
 #endif // INTEGRATE_H
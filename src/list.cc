@@ -33,8 +33,11 @@
 #include "array.h"
 #include "compare.h"
 #include "constants.h"
+#include "decimal.h"
 #include "expression.h"
 #include "grob.h"
+#include "hwfp.h"
+#include "integer.h"
 #include "locals.h"
 #include "parser.h"
 #include "polynomial.h"
@@ -47,6 +50,7 @@
 #include "utf8.h"
 #include "variables.h"
 
+#include <cmath>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -623,9 +627,9 @@ list_p list::append(object_p o) const
 //   Append object to list
 // ----------------------------------------------------------------------------
 {
-    text_g x = text_p(this);
-    text_g y = text::make(byte_p(o), o->size());
-    return list_p(+(x + y));
+    text_g  x    = text_p(this);
+    gcbytes data = byte_p(o);
+    return list_p(+text::append(x, data, o->size()));
 }
 
 
@@ -1715,31 +1719,319 @@ int value_compare(object_p *xp, object_p *yp)
 }
 
 
-static int value_compare_reverse(object_p *xp, object_p *yp)
+// ============================================================================
+//
+//   Sort engine
+//
+// ============================================================================
+//   Calling a comparison function with full type promotions for each of the
+//   O(n log n) comparisons is expensive. Instead, we first extract a compact
+//   key for each item, e.g. an approximate double value for numbers or the
+//   first bytes of a text, and sort these keys with a stable merge sort.
+//   The comparison function is only called when keys cannot decide.
+//
+//   The keys are stored in the scratchpad, which may move if a comparison
+//   causes a garbage collection, so they are copied in and out with memcpy.
+//   This also avoids alignment issues, since the scratchpad is byte-aligned.
+
+struct sort_entry
+// ----------------------------------------------------------------------------
+//   An entry in the sort table
+// ----------------------------------------------------------------------------
+{
+    enum kind { OTHER, NUMBER, TEXT, SYMBOL, MEMORY };
+    uint64_t key;               // Key that sorts like the item
+    uint     index;             // Index of the item from stack base
+    uint     kind;              // Kind of key, only same kinds compare
+};
+
+
+// Two numerical keys closer than this many ULPs need a full comparison
+static const uint64_t sort_number_ties = 1 << 16;
+
+
+static inline sort_entry sort_get(scribble &scr, size_t i)
 // ----------------------------------------------------------------------------
-//   Sort item according in decreasing value order
+//   Read an entry in the sort table
 // ----------------------------------------------------------------------------
 {
-    return -value_compare(xp, yp);
+    sort_entry e;
+    memcpy(&e, scr.scratch() + i * sizeof(e), sizeof(e));
+    return e;
 }
 
 
-static int memory_compare_reverse(object_p *xp, object_p *yp)
+static inline void sort_put(scribble &scr, size_t i, const sort_entry &e)
 // ----------------------------------------------------------------------------
-//   Sort item according in decreasing value order
+//   Write an entry in the sort table
 // ----------------------------------------------------------------------------
 {
-    return -memory_compare(xp, yp);
+    memcpy(scr.scratch() + i * sizeof(e), &e, sizeof(e));
 }
 
 
-static object::result do_sort(int (*compare)(object_p *x, object_p *y))
+static uint64_t sort_bytes(byte_p p, size_t len, uint bytes = 8)
 // ----------------------------------------------------------------------------
-//   RPL command for a sort
+//   Key made of the first bytes, sorting like memcmp
+// ----------------------------------------------------------------------------
+{
+    uint64_t key = 0;
+    for (uint i = 0; i < bytes; i++)
+        key = (key << 8) | (i < len ? p[i] : 0);
+    return key;
+}
+
+
+static bool sort_number(object_p obj, uint64_t &key)
+// ----------------------------------------------------------------------------
+//   Key for a real number, from an approximate double value
+// ----------------------------------------------------------------------------
+//   The double value only needs to be monotonic and within a few ULPs of the
+//   exact value, since close values are compared with the full comparison.
+{
+    double     value = 0;
+    object::id ty    = obj->type();
+    switch(ty)
+    {
+    case object::ID_integer:
+    case object::ID_neg_integer:
+        value = double(integer_p(obj)->value<ularge>());
+        if (ty == object::ID_neg_integer)
+            value = -value;
+        break;
+    case object::ID_hwfloat:
+        value = hwfloat_p(obj)->value();
+        break;
+    case object::ID_hwdouble:
+        value = hwdouble_p(obj)->value();
+        break;
+    case object::ID_decimal:
+    case object::ID_neg_decimal:
+    {
+        decimal_p      d     = decimal_p(obj);
+        decimal::info  s     = d->shape();
+        double         scale = 1e-3;
+        size_t         max   = s.nkigits < 6 ? s.nkigits : 6;
+        for (size_t i = 0; i < max; i++)
+        {
+            decimal::kint k = decimal::kigit(s.base, i);
+            if (k >= 1000)
+                return false;
+            value += k * scale;
+            scale *= 1e-3;
+        }
+        if (value != 0)
+        {
+            if (s.exponent > 400 || s.exponent < -400)
+                value = s.exponent > 0 ? HUGE_VAL : 0;
+            else
+                value *= std::pow(10.0, double(s.exponent));
+        }
+        if (ty == object::ID_neg_decimal)
+            value = -value;
+        break;
+    }
+    default:
+        return false;
+    }
+    if (std::isnan(value))
+        return false;
+
+    // Map the bits so that unsigned integer order matches double order
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    key = (bits >> 63) ? ~bits : bits | (uint64_t(1) << 63);
+    return true;
+}
+
+
+static sort_entry sort_key(object_p obj, uint index, sort_compare_fn compare)
+// ----------------------------------------------------------------------------
+//   Build the sort key for a given object
 // ----------------------------------------------------------------------------
+{
+    sort_entry e;
+    e.key   = 0;
+    e.index = index;
+    e.kind  = sort_entry::OTHER;
+
+    object::id ty = obj->type();
+    if (compare == memory_compare)
+    {
+        // Types sort in reverse order, then memory content after the type
+        size_t sz  = obj->size();
+        size_t tsz = leb128size(ty);
+        e.key  = (uint64_t(0xFFFF - ty) << 48)
+            | sort_bytes(byte_p(obj) + tsz, sz - tsz, 6);
+        e.kind = sort_entry::MEMORY;
+    }
+    else if (compare == value_compare)
+    {
+        if (ty == object::ID_text || ty == object::ID_symbol)
+        {
+            size_t len = 0;
+            utf8   txt = text_p(obj)->value(&len);
+            e.key  = sort_bytes(txt, len);
+            e.kind = ty == object::ID_text ? sort_entry::TEXT
+                                           : sort_entry::SYMBOL;
+        }
+        else if (sort_number(obj, e.key))
+        {
+            e.kind = sort_entry::NUMBER;
+        }
+    }
+    return e;
+}
+
+
+static int sort_compare(const sort_entry &x, const sort_entry &y,
+                        sort_compare_fn compare)
+// ----------------------------------------------------------------------------
+//   Compare two entries, using keys if possible
+// ----------------------------------------------------------------------------
+{
+    if (x.kind == y.kind && x.kind != sort_entry::OTHER && x.key != y.key)
+    {
+        uint64_t diff = x.key > y.key ? x.key - y.key : y.key - x.key;
+        if (x.kind != sort_entry::NUMBER || diff > sort_number_ties)
+            return x.key < y.key ? -1 : 1;
+    }
+    object_p *base = rt.stack_base();
+    return compare(base + x.index, base + y.index);
+}
+
+
+static void reverse_stack(uint count)
+// ----------------------------------------------------------------------------
+//   Reverse the order of the top count stack levels
+// ----------------------------------------------------------------------------
+{
+    object_p *base = rt.stack_base();
+    for (uint i = 0, j = count - 1; i < j; i++, j--)
+    {
+        object_p tmp = base[i];
+        base[i] = base[j];
+        base[j] = tmp;
+    }
+}
+
+
+static bool sort_stack_in_place(uint count, sort_compare_fn compare,
+                                bool reverse)
+// ----------------------------------------------------------------------------
+//   Sort the stack directly with qsort, when there is no room for keys
+// ----------------------------------------------------------------------------
+//   This is not stable, but does not need any memory
 {
     typedef int (*qsort_fn)(const void *, const void*);
+    object_p *base = rt.stack_base();
+    qsort(base, count, sizeof(object_p), qsort_fn(compare));
+    if (rt.error())
+        return false;
+    if (reverse)
+        reverse_stack(count);
+    return true;
+}
+
+
+bool sort_stack(uint count, sort_compare_fn compare, bool reverse)
+// ----------------------------------------------------------------------------
+//   Stable sort of the top count stack levels, with the smallest in level 1
+// ----------------------------------------------------------------------------
+{
+    if (count < 2)
+        return true;
+
+    // Two tables, one to merge from and one to merge into
+    scribble scr;
+    if (!rt.allocate(2 * count * sizeof(sort_entry)))
+    {
+        // Running out of memory is not fatal, sort the stack directly
+        rt.clear_error();
+        return sort_stack_in_place(count, compare, reverse);
+    }
+
+    // Extract the keys
+    for (uint i = 0; i < count; i++)
+    {
+        sort_entry e = sort_key(rt.stack_base()[i], i, compare);
+        sort_put(scr, i, e);
+    }
+
+    // Bottom-up merge sort, alternating between the two tables
+    int    sign = reverse ? -1 : 1;
+    size_t from = 0;
+    size_t to   = count;
+    for (size_t width = 1; width < count; width *= 2)
+    {
+        for (size_t lo = 0; lo < count; lo += 2 * width)
+        {
+            size_t mid = lo + width < count ? lo + width : count;
+            size_t hi  = mid + width < count ? mid + width : count;
 
+            // If the runs are already in order, only copy them
+            if (mid < hi)
+            {
+                sort_entry le  = sort_get(scr, from + mid - 1);
+                sort_entry re  = sort_get(scr, from + mid);
+                int        cmp = sign * sort_compare(le, re, compare);
+                if (rt.error())
+                    return false;
+                if (cmp <= 0)
+                    mid = hi;
+            }
+
+            size_t l = lo;
+            size_t r = mid;
+            size_t o = lo;
+
+            while (l < mid && r < hi)
+            {
+                sort_entry le  = sort_get(scr, from + l);
+                sort_entry re  = sort_get(scr, from + r);
+                int        cmp = sign * sort_compare(le, re, compare);
+                if (rt.error())
+                    return false;
+                if (cmp <= 0)
+                {
+                    sort_put(scr, to + o++, le);
+                    l++;
+                }
+                else
+                {
+                    sort_put(scr, to + o++, re);
+                    r++;
+                }
+            }
+            while (l < mid)
+                sort_put(scr, to + o++, sort_get(scr, from + l++));
+            while (r < hi)
+                sort_put(scr, to + o++, sort_get(scr, from + r++));
+        }
+        size_t tmp = from;
+        from = to;
+        to = tmp;
+    }
+
+    // Permute the stack, using the other table as a buffer (no GC here)
+    object_p *base   = rt.stack_base();
+    byte     *buffer = scr.scratch() + to * sizeof(sort_entry);
+    for (uint i = 0; i < count; i++)
+    {
+        sort_entry e = sort_get(scr, from + i);
+        memcpy(buffer + i * sizeof(object_p), base + e.index,
+               sizeof(object_p));
+    }
+    memcpy(base, buffer, count * sizeof(object_p));
+    return true;
+}
+
+
+static object::result do_sort(sort_compare_fn compare, bool reverse = false)
+// ----------------------------------------------------------------------------
+//   RPL command for a sort
+// ----------------------------------------------------------------------------
+{
     if  (object_p obj = rt.stack(0))
     {
         if (list_g items = obj->as_array_or_list())
@@ -1747,15 +2039,21 @@ static object::result do_sort(int (*compare)(object_p *x, object_p *y))
             size_t     depth = rt.depth();
             size_t     count;
             scribble   scr;
-            qsort_fn   cmp = qsort_fn(compare);
             object::id ity = items->type();
 
             for (object_p item : *items)
                 if (!rt.push(item))
                     goto err;
             count = rt.depth() - depth;
-            if (cmp)
-                qsort(rt.stack_base(), count, sizeof(object_p), cmp);
+
+            // The last item is in level 1, put the first one there so that
+            // equal items keep their order in the list
+            if (compare && count > 1)
+            {
+                reverse_stack(count);
+                if (!sort_stack(count, compare, reverse))
+                    goto err;
+            }
 
             for (uint i = 0; i < count; i++)
                 if (object_g obj = rt.stack(i))
@@ -1802,7 +2100,7 @@ COMMAND_BODY(ReverseSort)
 //   Sort contents of a list according to value
 // ----------------------------------------------------------------------------
 {
-    return do_sort(value_compare_reverse);
+    return do_sort(value_compare, true);
 }
 
 
@@ -1811,7 +2109,7 @@ COMMAND_BODY(ReverseQuickSort)
 //   Sort contents of a list using memory comparisons
 // ----------------------------------------------------------------------------
 {
-    return do_sort(memory_compare_reverse);
+    return do_sort(memory_compare, true);
 }
 
 
@@ -390,5 +390,12 @@ int memory_compare(object_p *xp, object_p *yp);
 // ----------------------------------------------------------------------------
 
 
+typedef int (*sort_compare_fn)(object_p *xp, object_p *yp);
+bool sort_stack(uint count, sort_compare_fn compare, bool reverse = false);
+// ----------------------------------------------------------------------------
+//   Stable sort of the top count stack levels, with the smallest in level 1
+// ----------------------------------------------------------------------------
+
+
 
 #endif // LIST_H
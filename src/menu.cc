@@ -1201,7 +1201,10 @@ MENU(IntegrationMenu,
      "Indep",   ID_Unimplemented,
 
      "Σ",       ID_Sum,
-     "∏",       ID_Product);
+     "∏",       ID_Product,
+     "Romberg", ID_RombergIntegration,
+     "G-K",     ID_GaussKronrodIntegration,
+     "TanhS",   ID_TanhSinhIntegration);
 
 MENU(SolverMenu,
 // ----------------------------------------------------------------------------
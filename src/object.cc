@@ -32,6 +32,7 @@
 #include "algebraic.h"
 #include "arithmetic.h"
 #include "array.h"
+#include "benchmark.h"
 #include "bignum.h"
 #include "catalog.h"
 #include "characters.h"
@@ -62,6 +63,7 @@
 #include "parser.h"
 #include "plot.h"
 #include "polynomial.h"
+#include "profiler.h"
 #include "program.h"
 #include "renderer.h"
 #include "runtime.h"
@@ -31,6 +31,7 @@
 
 #include "arithmetic.h"
 #include "compare.h"
+#include "compiled.h"
 #include "equations.h"
 #include "expression.h"
 #include "functions.h"
@@ -238,6 +239,14 @@ object::result draw_plot(object::id                  kind,
     save<symbol_g *> iref(expression::independent,
                           (symbol_g *) &ppar.independent);
     settings::PrepareForFunctionEvaluation willEvaluateFunction;
+    compiled_function fn(eq);
+
+    // For function plots, evaluate compiled code for batches of pixels
+    double xbatch = 0.0, dxbatch = 0.0;
+    double ybatch[compiled_function::BATCH];
+    uint   nbatch = 0, ibatch = 0;
+    bool   batch  = (kind == object::ID_Function && fn.compiled() &&
+                     compiled_function::as_double(step, dxbatch));
     if (ui.draw_graphics())
         if (Settings.DrawPlotAxes())
             draw_axes(ppar);
@@ -253,7 +262,25 @@ object::result draw_plot(object::id                  kind,
         uint  dcount = 1;
         if (dname == object::ID_Equation)
         {
-            y = algebraic::evaluate_function(eq, x);
+            y = nullptr;
+            if (batch)
+            {
+                if (ibatch >= nbatch &&
+                    compiled_function::as_double(x, xbatch))
+                {
+                    nbatch = compiled_function::BATCH;
+                    ibatch = 0;
+                    fn.run(xbatch, dxbatch, ybatch, nbatch);
+                }
+                if (ibatch < nbatch)
+                {
+                    double fy = ybatch[ibatch++];
+                    if (std::isfinite(fy))
+                        y = compiled_function::from_double(fy);
+                }
+            }
+            if (!y)
+                y = fn.evaluate(x);
         }
         else
         {
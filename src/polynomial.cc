@@ -602,6 +602,682 @@ polynomial_p polynomial::sub(polynomial_r x, polynomial_r y)
 }
 
 
+// ============================================================================
+//
+//   Heap-based multiplication of polynomials
+//
+// ============================================================================
+//
+//   This uses Johnson's algorithm. When the terms of x and y are sorted by
+//   decreasing exponents, the products x[a]*y[b] for a given row a are also
+//   sorted. A heap holding the next product in each row therefore returns
+//   all products with the same exponents one after the other, and they can
+//   be summed before anything is written out.
+//
+//   Exponents are packed in a single ularge, first variable in the high
+//   bits, with enough bits for each variable to hold the largest exponent
+//   in the product. Multiplying monomials is then adding packed exponents.
+//   When all factors are small integers, their products are summed natively.
+//
+//   Terms are emitted in the order the term-by-term algorithm generated,
+//   i.e. sorted by the last pair of terms that contributed to them.
+
+struct poly_term
+// ----------------------------------------------------------------------------
+//   A non-zero term of an input polynomial, stored in the scratchpad
+// ----------------------------------------------------------------------------
+{
+    ularge      key;            // Packed exponents
+    large       value;          // Value of the factor if it is an integer
+    size_t      offset;         // Offset of the factor in the polynomial
+    size_t      index;          // Position of the term in the polynomial
+};
+
+
+struct poly_product
+// ----------------------------------------------------------------------------
+//   Entry in the heap, representing the product of row a and column b
+// ----------------------------------------------------------------------------
+{
+    ularge      key;            // Packed exponents of the product
+    size_t      a;              // Term in the polynomial with fewer terms
+    size_t      b;              // Term in the other polynomial
+};
+
+
+struct poly_output
+// ----------------------------------------------------------------------------
+//   Index of an output term, used to put the terms back in order
+// ----------------------------------------------------------------------------
+{
+    ularge      rank;           // Last pair of input terms contributing
+    size_t      offset;         // Offset of the term in the output
+    size_t      size;           // Size of the term in bytes
+};
+
+
+template <typename T>
+static inline T poly_get(byte_p base, size_t index)
+// ----------------------------------------------------------------------------
+//   Read a record in the scratchpad, which may not be aligned
+// ----------------------------------------------------------------------------
+{
+    T result;
+    memcpy(&result, base + index * sizeof(T), sizeof(T));
+    return result;
+}
+
+
+template <typename T>
+static inline void poly_put(byte *base, size_t index, const T &value)
+// ----------------------------------------------------------------------------
+//   Write a record in the scratchpad, which may not be aligned
+// ----------------------------------------------------------------------------
+{
+    memcpy(base + index * sizeof(T), &value, sizeof(T));
+}
+
+
+static int poly_term_compare(const void *left, const void *right)
+// ----------------------------------------------------------------------------
+//   Sort terms by decreasing exponents
+// ----------------------------------------------------------------------------
+{
+    ularge l = poly_get<poly_term>(byte_p(left), 0).key;
+    ularge r = poly_get<poly_term>(byte_p(right), 0).key;
+    return l < r ? 1 : l > r ? -1 : 0;
+}
+
+
+static int poly_output_compare(const void *left, const void *right)
+// ----------------------------------------------------------------------------
+//   Sort output terms by increasing rank
+// ----------------------------------------------------------------------------
+{
+    ularge l = poly_get<poly_output>(byte_p(left), 0).rank;
+    ularge r = poly_get<poly_output>(byte_p(right), 0).rank;
+    return l < r ? -1 : l > r ? 1 : 0;
+}
+
+
+static void poly_heap_push(byte *heap, size_t &count, const poly_product &item)
+// ----------------------------------------------------------------------------
+//   Insert a product in the heap, largest exponents at the top
+// ----------------------------------------------------------------------------
+{
+    size_t i = count++;
+    while (i)
+    {
+        size_t       parent = (i - 1) / 2;
+        poly_product above  = poly_get<poly_product>(heap, parent);
+        if (above.key >= item.key)
+            break;
+        poly_put(heap, i, above);
+        i = parent;
+    }
+    poly_put(heap, i, item);
+}
+
+
+static poly_product poly_heap_pop(byte *heap, size_t &count)
+// ----------------------------------------------------------------------------
+//   Remove the product with the largest exponents from the heap
+// ----------------------------------------------------------------------------
+{
+    poly_product top  = poly_get<poly_product>(heap, 0);
+    poly_product last = poly_get<poly_product>(heap, --count);
+    size_t       i    = 0;
+    for (size_t child = 1; child < count; child = 2 * i + 1)
+    {
+        poly_product below = poly_get<poly_product>(heap, child);
+        if (child + 1 < count)
+        {
+            poly_product other = poly_get<poly_product>(heap, child + 1);
+            if (other.key > below.key)
+            {
+                below = other;
+                child++;
+            }
+        }
+        if (below.key <= last.key)
+            break;
+        poly_put(heap, i, below);
+        i = child;
+    }
+    if (count)
+        poly_put(heap, i, last);
+    return top;
+}
+
+
+static large poly_integer(algebraic_p factor)
+// ----------------------------------------------------------------------------
+//   Return the value of an integer factor, or 0 for other types
+// ----------------------------------------------------------------------------
+{
+    object::id ty = factor->type();
+    if (ty != object::ID_integer && ty != object::ID_neg_integer)
+        return 0;
+    large value = integer_p(factor)->value<ularge>();
+    return ty == object::ID_neg_integer ? -value : value;
+}
+
+
+static size_t poly_scan(polynomial_r poly, const size_t *map, ularge *maxexp,
+                        ularge &maxint, ularge &sumint, bool &integers,
+                        size_t &all)
+// ----------------------------------------------------------------------------
+//   Count non-zero terms, find largest exponents and check integer factors
+// ----------------------------------------------------------------------------
+//   sumint is the sum of the magnitudes of integer factors, or ~0 if too large
+{
+    size_t count = 0;
+    all = 0;
+    for (auto term : *poly)
+    {
+        algebraic_p factor = term.factor();
+        bool        zero   = factor->is_zero(false);
+        if (integers && !zero)
+        {
+            object::id ty = factor->type();
+            integers = (ty == object::ID_integer ||
+                        ty == object::ID_neg_integer) &&
+                integer_p(factor)->native();
+            if (integers)
+            {
+                ularge value = integer_p(factor)->value<ularge>();
+                if (value > maxint)
+                    maxint = value;
+                if (__builtin_add_overflow(sumint, value, &sumint))
+                    sumint = ~ularge(0);
+            }
+        }
+        for (size_t v = 0; v < term.variables; v++)
+        {
+            ularge exp = term.exponent();
+            if (!zero && exp > maxexp[map[v]])
+                maxexp[map[v]] = exp;
+        }
+        if (!zero)
+            count++;
+        all++;
+    }
+    return count;
+}
+
+
+static void poly_fill(polynomial_r poly, const size_t *map, const uint *shift,
+                      scribble &scr, size_t terms)
+// ----------------------------------------------------------------------------
+//   Record the non-zero terms with their packed exponents, and sort them
+// ----------------------------------------------------------------------------
+//   Checking if a factor is zero may allocate, e.g. for fractions, which
+//   moves the scratchpad, so the terms are addressed from scr every time
+{
+    size_t count = 0;
+    size_t index = 0;
+    for (auto term : *poly)
+    {
+        size_t      offset = term.offset;
+        algebraic_p factor = term.factor();
+        ularge      key    = 0;
+        for (size_t v = 0; v < term.variables; v++)
+            if (ularge exp = term.exponent())
+                key |= exp << shift[map[v]];
+        if (!factor->is_zero(false))
+        {
+            large value = poly_integer(factor);
+            poly_put(scr.scratch() + terms, count++,
+                     poly_term{ key, value, offset, index });
+        }
+        index++;
+    }
+    qsort(scr.scratch() + terms, count, sizeof(poly_term), poly_term_compare);
+}
+
+
+static bool poly_emit(ularge rank, large value, algebraic_r factor,
+                      const ularge *exps, size_t nvars)
+// ----------------------------------------------------------------------------
+//   Emit an output term in the scratchpad, preceded with its rank
+// ----------------------------------------------------------------------------
+//   If factor is null, the factor is the integer value
+{
+    object::id ty    = value < 0 ? object::ID_neg_integer : object::ID_integer;
+    ularge     mag   = value < 0 ? -ularge(value) : ularge(value);
+    size_t     fsize = factor
+        ? factor->size()
+        : leb128size(uint(ty)) + leb128size(mag);
+    size_t     esize = 0;
+    for (size_t v = 0; v < nvars; v++)
+        esize += leb128size(exps[v]);
+
+    byte *p = rt.allocate(sizeof(rank) + fsize + esize);
+    if (!p)
+        return false;
+    memcpy(p, &rank, sizeof(rank));
+    p += sizeof(rank);
+    if (factor)
+    {
+        memcpy(p, +factor, fsize);
+        p += fsize;
+    }
+    else
+    {
+        p = leb128(p, uint(ty));
+        p = leb128(p, mag);
+    }
+    for (size_t v = 0; v < nvars; v++)
+        p = leb128(p, exps[v]);
+    return true;
+}
+
+
+static polynomial_p poly_reorder(scribble &scr, size_t start, size_t output,
+                                 size_t outputs, size_t nvars)
+// ----------------------------------------------------------------------------
+//   Put the output terms back in order, dropping the ranks
+// ----------------------------------------------------------------------------
+//   The terms were emitted at offset output from start, and are moved to start
+{
+    size_t osize = scr.growth() - start - output;
+    size_t isize = outputs * sizeof(poly_output);
+    size_t fsize = osize - outputs * sizeof(ularge);
+    if (outputs && !rt.allocate(isize + fsize))
+        return nullptr;
+
+    byte  *base   = scr.scratch() + start;
+    byte  *terms  = base + output;
+    byte  *index  = terms + osize;
+    byte  *sorted = index + isize;
+    byte_p p      = terms;
+    for (size_t o = 0; o < outputs; o++)
+    {
+        ularge rank;
+        memcpy(&rank, p, sizeof(rank));
+        byte_p term = p + sizeof(rank);
+        p = byte_p(object_p(term)->skip());
+        for (size_t v = 0; v < nvars; v++)
+            p = leb128skip(p);
+        poly_put(index, o, poly_output{ rank,
+                                        size_t(term - terms),
+                                        size_t(p - term) });
+    }
+    qsort(index, outputs, sizeof(poly_output), poly_output_compare);
+
+    byte *q = sorted;
+    for (size_t o = 0; o < outputs; o++)
+    {
+        poly_output out = poly_get<poly_output>(index, o);
+        memcpy(q, terms + out.offset, out.size);
+        q += out.size;
+    }
+    memmove(base, sorted, fsize);
+    rt.free(scr.growth() - start - fsize);
+
+    gcbytes data   = scr.scratch();
+    size_t  datasz = scr.growth();
+    return rt.make<polynomial>(data, datasz);
+}
+
+
+enum { KARATSUBA_THRESHOLD = 16 };
+
+
+static void schoolbook(const large *a, const large *b, size_t n, large *r)
+// ----------------------------------------------------------------------------
+//   Multiply two dense polynomials with n coefficients, 2n-1 in result
+// ----------------------------------------------------------------------------
+{
+    for (size_t i = 0; i < 2 * n - 1; i++)
+        r[i] = 0;
+    for (size_t i = 0; i < n; i++)
+        if (large ai = a[i])
+            for (size_t j = 0; j < n; j++)
+                r[i + j] += ai * b[j];
+}
+
+
+static size_t karatsuba_scratch(size_t n)
+// ----------------------------------------------------------------------------
+//   Number of temporary coefficients required by karatsuba for size n
+// ----------------------------------------------------------------------------
+{
+    if (n <= KARATSUBA_THRESHOLD)
+        return 0;
+    size_t m = (n + 1) / 2;
+    return 4 * m + karatsuba_scratch(m);
+}
+
+
+static void karatsuba(const large *a, const large *b, size_t n,
+                      large *r, large *tmp)
+// ----------------------------------------------------------------------------
+//   Multiply two dense polynomials with n coefficients, 2n-1 in result
+// ----------------------------------------------------------------------------
+//   With a = a0 + a1*X^m and b = b0 + b1*X^m, the result is
+//   a0*b0 + ((a0+a1)*(b0+b1) - a0*b0 - a1*b1)*X^m + a1*b1*X^2m
+{
+    if (n <= KARATSUBA_THRESHOLD)
+    {
+        schoolbook(a, b, n, r);
+        return;
+    }
+
+    size_t m    = (n + 1) / 2;
+    size_t h    = n - m;
+    large *sa   = tmp;
+    large *sb   = tmp + m;
+    large *mid  = tmp + 2 * m;
+    large *next = tmp + 4 * m;
+
+    karatsuba(a, b, m, r, next);
+    karatsuba(a + m, b + m, h, r + 2 * m, next);
+    r[2 * m - 1] = 0;
+
+    for (size_t i = 0; i < m; i++)
+    {
+        sa[i] = a[i] + (i < h ? a[m + i] : 0);
+        sb[i] = b[i] + (i < h ? b[m + i] : 0);
+    }
+    karatsuba(sa, sb, m, mid, next);
+    for (size_t i = 0; i < 2 * m - 1; i++)
+        mid[i] -= r[i];
+    for (size_t i = 0; i < 2 * h - 1; i++)
+        mid[i] -= r[2 * m + i];
+    for (size_t i = 0; i < 2 * m - 1; i++)
+        r[m + i] += mid[i];
+}
+
+
+static size_t poly_next_degree(large *next, size_t k)
+// ----------------------------------------------------------------------------
+//   Find the first degree from k that still needs a rank, compressing the path
+// ----------------------------------------------------------------------------
+{
+    while (size_t(next[k]) != k)
+    {
+        next[k] = next[next[k]];
+        k = next[k];
+    }
+    return k;
+}
+
+
+static polynomial_p poly_dense_mul(polynomial_r x, polynomial_r y,
+                                   scribble &scr, ularge dx, ularge dy,
+                                   size_t xall, size_t yall)
+// ----------------------------------------------------------------------------
+//   Multiply univariate polynomials with dense integer coefficients
+// ----------------------------------------------------------------------------
+//   The coefficients are expanded in arrays indexed by degree, multiplied
+//   with Karatsuba's algorithm, and the non-zero ones emitted as terms.
+//   The rank of each term comes from a table indexed by degree, where each
+//   degree takes the rank of the last x term with a matching y term.
+{
+    size_t n      = std::max(dx, dy) + 1;
+    size_t nr     = dx + dy + 1;
+    size_t tsize  = karatsuba_scratch(n);
+    size_t words  = 2 * n + (2 * n - 1) + tsize + xall + (dy + 1) + 2 * nr + 1;
+    size_t start  = scr.growth();
+    size_t output = words * sizeof(large) + sizeof(large);
+    byte  *base   = rt.allocate(output);
+    if (!base)
+        return nullptr;
+
+    // Align the arrays, which stay in place until we emit terms
+    size_t pad   = -uintptr_t(base) & (sizeof(large) - 1);
+    large *a     = (large *) (base + pad);
+    large *b     = a + n;
+    large *r     = b + n;
+    large *tmp   = r + 2 * n - 1;
+    large *xdeg  = tmp + tsize;
+    large *yidx  = xdeg + xall;
+    large *ranks = yidx + dy + 1;
+    large *next  = ranks + nr;
+    for (size_t i = 0; i < 2 * n; i++)
+        a[i] = 0;
+    for (size_t d = 0; d <= dy; d++)
+        yidx[d] = -1;
+    for (size_t k = 0; k < nr; k++)
+        ranks[k] = 0;
+    for (size_t k = 0; k <= nr; k++)
+        next[k] = k;
+
+    size_t index = 0;
+    for (auto term : *x)
+    {
+        algebraic_p factor = term.factor();
+        ularge      deg    = term.variables ? term.exponent() : 0;
+        large       value  = poly_integer(factor);
+        a[deg] += value;
+        xdeg[index++] = value ? large(deg) : -1;
+    }
+    index = 0;
+    for (auto term : *y)
+    {
+        algebraic_p factor = term.factor();
+        ularge      deg    = term.variables ? term.exponent() : 0;
+        large       value  = poly_integer(factor);
+        b[deg] += value;
+        if (value)
+            yidx[deg] = index;
+        index++;
+    }
+    karatsuba(a, b, n, r, tmp);
+
+    // Degrees with a zero coefficient are not emitted and need no rank.
+    // Skip them now, otherwise they would be scanned again for each x term
+    for (size_t k = 0; k < nr; k++)
+        if (!r[k])
+            next[k] = k + 1;
+
+    // Rank each degree from the last x term with a matching y term.
+    // Degrees that got their rank are skipped, so each is ranked only once
+    for (size_t i = xall; i-- > 0; )
+    {
+        large d = xdeg[i];
+        if (d < 0)
+            continue;
+        size_t last = d + dy;
+        for (size_t k = poly_next_degree(next, d);
+             k <= last;
+             k = poly_next_degree(next, k + 1))
+        {
+            large j = yidx[k - d];
+            if (j >= 0)
+            {
+                ranks[k] = i * yall + j;
+                next[k] = k + 1;
+            }
+        }
+    }
+
+    // Emit terms, which moves the scratchpad and may misalign the arrays
+    size_t outputs = 0;
+    size_t roffs   = pad + 2 * n * sizeof(large);
+    size_t koffs   = roffs
+                   + (2 * n - 1 + tsize + xall + dy + 1) * sizeof(large);
+    for (ularge k = nr; k-- > 0; )
+    {
+        base = scr.scratch() + start;
+        large value = poly_get<large>(base + roffs, k);
+        if (!value)
+            continue;
+
+        ularge rank = poly_get<large>(base + koffs, k);
+        if (!poly_emit(rank, value, nullptr, &k, 1))
+            return nullptr;
+        outputs++;
+    }
+    return poly_reorder(scr, start, output, outputs, 1);
+}
+
+
+static polynomial_p poly_heap_mul(polynomial_r x, polynomial_r y,
+                                  scribble &scr, size_t nvars,
+                                  const size_t *xvar, const size_t *yvar,
+                                  bool &packed)
+// ----------------------------------------------------------------------------
+//   Multiply polynomials whose variables were copied in scr
+// ----------------------------------------------------------------------------
+//   If the exponents of the product cannot be packed, packed is set to false
+{
+    ularge xmax[nvars];
+    ularge ymax[nvars];
+    for (size_t v = 0; v < nvars; v++)
+        xmax[v] = ymax[v] = 0;
+
+    ularge xint     = 0;
+    ularge yint     = 0;
+    ularge xsum     = 0;
+    ularge ysum     = 0;
+    bool   integers = true;
+    size_t xall     = 0;
+    size_t yall     = 0;
+    size_t nx       = poly_scan(x, xvar, xmax, xint, xsum, integers, xall);
+    size_t ny       = poly_scan(y, yvar, ymax, yint, ysum, integers, yall);
+
+    // Check if the exponents of the product fit in a ularge
+    uint   shift[nvars];
+    ularge mask[nvars];
+    uint   bits = 0;
+    for (size_t v = nvars; v-- > 0; )
+    {
+        ularge top   = xmax[v] + ymax[v];
+        uint   width = top ? 64 - __builtin_clzll(top) : 0;
+        if (top < xmax[v] || bits + width > 64)
+        {
+            packed = false;
+            return nullptr;
+        }
+        shift[v] = bits;
+        mask[v]  = width < 64 ? (ularge(1) << width) - 1 : ~ularge(0);
+        bits += width;
+    }
+
+    // Check if integer sums can overflow
+    if (integers)
+    {
+        ularge bound = 0;
+        integers = !__builtin_mul_overflow(xint, yint, &bound) &&
+                   !__builtin_mul_overflow(bound, std::min(nx, ny), &bound) &&
+                   bound < (ularge(1) << 63);
+    }
+
+    // If either polynomial is zero, the product is zero
+    if (!nx || !ny)
+    {
+        gcbytes data   = scr.scratch();
+        size_t  datasz = scr.growth();
+        return rt.make<polynomial>(data, datasz);
+    }
+
+    // Dense univariate integer polynomials use Karatsuba multiplication
+    if (integers && nvars == 1 &&
+        nx >= KARATSUBA_THRESHOLD && 2 * nx > xmax[0] &&
+        ny >= KARATSUBA_THRESHOLD && 2 * ny > ymax[0] &&
+        xmax[0] <= 2 * ymax[0] + 1 && ymax[0] <= 2 * xmax[0] + 1)
+    {
+        ularge bound = 0;
+        if (!__builtin_mul_overflow(xsum, ysum, &bound) &&
+            bound < (ularge(1) << 61))
+            return poly_dense_mul(x, y, scr, xmax[0], ymax[0], xall, yall);
+    }
+
+    // Allocate the two sets of terms and a heap with one entry per row
+    bool   swap   = nx > ny;
+    size_t na     = swap ? ny : nx;
+    size_t nb     = swap ? nx : ny;
+    size_t start  = scr.growth();
+    size_t xsize  = nx * sizeof(poly_term);
+    size_t ysize  = ny * sizeof(poly_term);
+    size_t aoffs  = swap ? xsize : 0;
+    size_t boffs  = swap ? 0 : xsize;
+    size_t hoffs  = xsize + ysize;
+    size_t output = hoffs + na * sizeof(poly_product);
+    if (!rt.allocate(output))
+        return nullptr;
+
+    poly_fill(x, xvar, shift, scr, start);
+    poly_fill(y, yvar, shift, scr, start + xsize);
+
+    // Initially, the heap holds the first column of each row
+    byte  *base  = scr.scratch() + start;
+    size_t count = 0;
+    ularge bkey  = poly_get<poly_term>(base + boffs, 0).key;
+    for (size_t a = 0; a < na; a++)
+    {
+        ularge akey = poly_get<poly_term>(base + aoffs, a).key;
+        poly_heap_push(base + hoffs, count, { akey + bkey, a, 0 });
+    }
+
+    // Extract products by decreasing exponents, summing equal exponents
+    size_t outputs = 0;
+    while (count)
+    {
+        base                = scr.scratch() + start;
+        ularge      key     = poly_get<poly_product>(base + hoffs, 0).key;
+        ularge      rank    = 0;
+        large       sum     = 0;
+        algebraic_g total   = nullptr;
+        while (count)
+        {
+            base = scr.scratch() + start;
+            byte *heap = base + hoffs;
+            if (poly_get<poly_product>(heap, 0).key != key)
+                break;
+
+            poly_product prod = poly_heap_pop(heap, count);
+            poly_term    at   = poly_get<poly_term>(base + aoffs, prod.a);
+            poly_term    bt   = poly_get<poly_term>(base + boffs, prod.b);
+            if (prod.b + 1 < nb)
+            {
+                ularge next = poly_get<poly_term>(base+boffs, prod.b+1).key;
+                poly_heap_push(heap, count,
+                               { at.key + next, prod.a, prod.b + 1 });
+            }
+
+            poly_term &xt = swap ? bt : at;
+            poly_term &yt = swap ? at : bt;
+            if (integers)
+            {
+                sum += xt.value * yt.value;
+            }
+            else
+            {
+                algebraic_g xf = algebraic_p(byte_p(+x) + xt.offset);
+                algebraic_g yf = algebraic_p(byte_p(+y) + yt.offset);
+                algebraic_g pf = xf * yf;
+                if (!pf)
+                    return nullptr;
+                if (pf->is_zero(false))
+                    continue;
+                total = total ? pf + total : pf;
+                if (!total)
+                    return nullptr;
+            }
+            ularge r = xt.index * yall + yt.index;
+            if (r > rank)
+                rank = r;
+        }
+
+        // Emit the term if it did not cancel out
+        if (integers ? sum != 0 : total && !total->is_zero(false))
+        {
+            ularge exps[nvars];
+            for (size_t v = 0; v < nvars; v++)
+                exps[v] = mask[v] ? (key >> shift[v]) & mask[v] : 0;
+            if (!poly_emit(rank, sum, total, exps, nvars))
+                return nullptr;
+            outputs++;
+        }
+    }
+
+    return poly_reorder(scr, start, output, outputs, nvars);
+}
+
+
 polynomial_p polynomial::mul(polynomial_r x, polynomial_r y)
 // ----------------------------------------------------------------------------
 //   Multiply two polynomials
@@ -648,7 +1324,13 @@ polynomial_p polynomial::mul(polynomial_r x, polynomial_r y)
         p += nlen;
     }
 
-    // Loop over all the terms in X
+    // Use the heap-based algorithm if the exponents can be packed
+    bool packed = true;
+    polynomial_p product = poly_heap_mul(x, y, scr, nvars, xvar, yvar, packed);
+    if (packed)
+        return product;
+
+    // Otherwise, loop over all the terms in X
     gcbytes terms = p;
     for (auto xterm : *x)
     {
@@ -883,10 +1565,13 @@ polynomial_p polynomial::pow(polynomial_r x, ularge exp)
             if (!r)
                 return nullptr;
         }
-        m = mul(m, m);
-        if (!m)
-            return nullptr;
         exp >>= 1;
+        if (exp)
+        {
+            m = mul(m, m);
+            if (!m)
+                return nullptr;
+        }
     }
 
     if (!r)
@@ -1123,6 +1808,52 @@ PARSE_BODY(polynomial)
 }
 
 
+static algebraic_p poly_horner(polynomial_r poly, algebraic_r x, bool &sorted)
+// ----------------------------------------------------------------------------
+//   Evaluate a univariate polynomial using Horner's rule
+// ----------------------------------------------------------------------------
+//   This requires terms sorted by decreasing exponents, otherwise sorted is
+//   set to false and the polynomial is not evaluated
+{
+    ularge last = ~ularge(0);
+    for (auto term : *poly)
+    {
+        term.factor();
+        ularge exp = term.exponent();
+        if (exp >= last)
+        {
+            sorted = false;
+            return nullptr;
+        }
+        last = exp;
+    }
+
+    sorted = true;
+    algebraic_g result = nullptr;
+    for (auto term : *poly)
+    {
+        algebraic_g factor = term.factor();
+        ularge      exp    = term.exponent();
+        if (result)
+        {
+            ularge      gap   = last - exp;
+            algebraic_g scale = gap == 1 ? x : ::pow(x, gap);
+            result = result * scale + factor;
+            if (!result)
+                return nullptr;
+        }
+        else
+        {
+            result = factor;
+        }
+        last = exp;
+    }
+    if (result && last)
+        result = result * (last == 1 ? x : ::pow(x, last));
+    return result;
+}
+
+
 EVAL_BODY(polynomial)
 // ----------------------------------------------------------------------------
 //   We can evaluate polynomials a bit faster than usual expressions
@@ -1151,28 +1882,40 @@ EVAL_BODY(polynomial)
         vars[v] = alg;
     }
 
-    // Loop over all factors
+    // A univariate polynomial with a numerical value uses Horner's rule
     algebraic_g result = nullptr;
-    for (auto term : *poly)
+    bool        sorted = false;
+    if (nvars == 1 && (is_real(vars[0]->type()) || is_complex(vars[0]->type())))
     {
-        algebraic_g factor = term.factor();
-        if (!factor->is_zero(false))
+        result = poly_horner(poly, vars[0], sorted);
+        if (sorted && !result && rt.error())
+            return ERROR;
+    }
+
+    // Otherwise, loop over all factors
+    if (!sorted)
+    {
+        for (auto term : *poly)
         {
-            for (size_t v = 0; v < nvars; v++)
+            algebraic_g factor = term.factor();
+            if (!factor->is_zero(false))
             {
-                ularge exponent = term.exponent();
-                if (exponent)
+                for (size_t v = 0; v < nvars; v++)
                 {
-                    algebraic_g value =
-                        exponent == 1 ? vars[v] : ::pow(vars[v], exponent);
-                    factor = factor * value;
-                    if (!factor)
-                        return ERROR;
+                    ularge exponent = term.exponent();
+                    if (exponent)
+                    {
+                        algebraic_g value =
+                            exponent == 1 ? vars[v] : ::pow(vars[v], exponent);
+                        factor = factor * value;
+                        if (!factor)
+                            return ERROR;
+                    }
                 }
+                result = result ? result + factor : factor;
+                if (!result)
+                    return ERROR;
             }
-            result = result ? result + factor : factor;
-            if (!result)
-                return ERROR;
         }
     }
     if (!result)
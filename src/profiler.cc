@@ -0,0 +1,337 @@
+// ****************************************************************************
+//  profiler.cc                                                   DB48X project
+// ****************************************************************************
+//
+//   File Description:
+//
+//     Attribute execution time, allocations and garbage collection time
+//     to individual commands and named programs
+//
+//
+//
+//
+//
+//
+//
+// ****************************************************************************
+//   (C) 2024 Christophe de Dinechin <christophe@dinechin.org>
+//   This software is licensed under the terms outlined in LICENSE.txt
+// ****************************************************************************
+//   This file is part of DB48X.
+//
+//   DB48X is free software: you can redistribute it and/or modify
+//   it under the terms outlined in the LICENSE.txt file
+//
+//   DB48X is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include "profiler.h"
+
+#include "integer.h"
+#include "program.h"
+#include "symbol.h"
+#include "text.h"
+
+#include <stdlib.h>
+
+RECORDER(profiler, 16, "Profiler");
+
+
+bool profiler::active = false;
+
+
+struct profile_cost
+// ----------------------------------------------------------------------------
+//   Cost accumulated for a command or a named program
+// ----------------------------------------------------------------------------
+{
+    uint32_t calls;
+    uint32_t time;
+    uint32_t gctime;
+    size_t   bytes;
+};
+
+
+struct profile_data
+// ----------------------------------------------------------------------------
+//   Data collected while profiling, allocated only while profiling
+// ----------------------------------------------------------------------------
+{
+    enum { MAX_PROGRAMS = 32, MAX_NAME = 24, MAX_FRAMES = 16 };
+
+    struct named_cost : profile_cost
+    {
+        char            name[MAX_NAME];
+    };
+
+    struct frame
+    {
+        named_cost *    entry;          // Program being measured
+        size_t          depth;          // Call depth while it runs
+        profiler::counters start;       // Counters when it started
+        bool            nested;         // Recursive call, already measured
+    };
+
+    profile_cost        commands[object::NUM_IDS];
+    named_cost          programs[MAX_PROGRAMS];
+    frame               frames[MAX_FRAMES];
+    uint                nprograms;
+    uint                nframes;
+    profiler::counters  nested;         // Costs measured by inner samples
+};
+
+static profile_data *Profiling = nullptr;
+
+
+static inline profiler::counters now()
+// ----------------------------------------------------------------------------
+//   Read the current value of the counters
+// ----------------------------------------------------------------------------
+{
+    return { sys_current_ms(), rt.gc_duration(), rt.allocated_bytes() };
+}
+
+
+static inline size_t delta(size_t end, size_t start)
+// ----------------------------------------------------------------------------
+//   Difference that cannot wrap around, e.g. if globals shrink
+// ----------------------------------------------------------------------------
+{
+    return end > start ? end - start : 0;
+}
+
+
+static inline profiler::counters delta(const profiler::counters &end,
+                                       const profiler::counters &start)
+// ----------------------------------------------------------------------------
+//   Difference between two counter values
+// ----------------------------------------------------------------------------
+{
+    return { end.time - start.time,
+             delta(end.gctime, start.gctime),
+             delta(end.bytes, start.bytes) };
+}
+
+
+static inline void add(profile_cost &cost, const profiler::counters &c)
+// ----------------------------------------------------------------------------
+//   Add counters to a cost entry
+// ----------------------------------------------------------------------------
+{
+    cost.time   += c.time;
+    cost.gctime += c.gctime;
+    cost.bytes  += c.bytes;
+}
+
+
+static void leave(const profiler::counters &end, size_t depth)
+// ----------------------------------------------------------------------------
+//   Account for the named programs that returned below the given depth
+// ----------------------------------------------------------------------------
+{
+    profile_data &p = *Profiling;
+    while (p.nframes && p.frames[p.nframes - 1].depth > depth)
+    {
+        profile_data::frame &f = p.frames[--p.nframes];
+        if (!f.nested)
+            add(*f.entry, delta(end, f.start));
+    }
+}
+
+
+static void enter(symbol_p sym, const profiler::counters &start)
+// ----------------------------------------------------------------------------
+//   Start measuring a program that was called by name
+// ----------------------------------------------------------------------------
+{
+    profile_data &p    = *Profiling;
+    size_t        len  = 0;
+    utf8          name = sym->value(&len);
+    if (len >= profile_data::MAX_NAME)
+        len = profile_data::MAX_NAME - 1;
+
+    profile_data::named_cost *entry = nullptr;
+    for (uint i = 0; i < p.nprograms && !entry; i++)
+        if (strncmp(p.programs[i].name, cstring(name), len) == 0 &&
+            !p.programs[i].name[len])
+            entry = &p.programs[i];
+    if (!entry)
+    {
+        if (p.nprograms >= profile_data::MAX_PROGRAMS)
+        {
+            record(profiler, "Too many programs, ignoring one");
+            return;
+        }
+        entry = &p.programs[p.nprograms++];
+        memcpy(entry->name, name, len);
+        entry->name[len] = 0;
+    }
+    entry->calls++;
+
+    if (p.nframes >= profile_data::MAX_FRAMES)
+        return;
+    bool nested = false;
+    for (uint f = 0; f < p.nframes && !nested; f++)
+        nested = p.frames[f].entry == entry;
+    p.frames[p.nframes++] = { entry, rt.call_depth(), start, nested };
+}
+
+
+profiler::sample::sample()
+// ----------------------------------------------------------------------------
+//   Start measuring the evaluation of an object
+// ----------------------------------------------------------------------------
+    : start(now()), outer(Profiling->nested), depth(rt.call_depth())
+{
+    Profiling->nested = counters();
+}
+
+
+void profiler::sample::done(object_r obj)
+// ----------------------------------------------------------------------------
+//   Attribute the exclusive cost of the evaluation to the object's type
+// ----------------------------------------------------------------------------
+{
+    profile_data &p     = *Profiling;
+    counters      end   = now();
+    counters      total = delta(end, start);
+    id            ty    = obj->type();
+    profile_cost &cost  = p.commands[ty];
+    cost.calls++;
+    add(cost, delta(total, p.nested));
+    p.nested = { outer.time + total.time,
+                 outer.gctime + total.gctime,
+                 outer.bytes + total.bytes };
+
+    // Named programs run after the evaluation of their name pushed them
+    leave(end, rt.call_depth());
+    if (ty == object::ID_symbol && rt.call_depth() > depth)
+        enter(symbol_p(+obj), end);
+}
+
+
+bool profiler::start()
+// ----------------------------------------------------------------------------
+//   Allocate the profiling data and activate profiling
+// ----------------------------------------------------------------------------
+{
+    if (active)
+    {
+        rt.recursion_error();
+        return false;
+    }
+    Profiling = (profile_data *) calloc(1, sizeof(profile_data));
+    if (!Profiling)
+    {
+        rt.out_of_memory_error();
+        return false;
+    }
+    record(profiler, "Profiling started, %u bytes", sizeof(profile_data));
+    active = true;
+    return true;
+}
+
+
+list_p profiler::stop()
+// ----------------------------------------------------------------------------
+//   Stop profiling and return the costs, sorted by bytes allocated
+// ----------------------------------------------------------------------------
+//   The first row is a header with the name of each column.
+//   Commands are shown as text, named programs as symbols.
+{
+    if (!active)
+        return nullptr;
+    active = false;
+
+    profile_data &p = *Profiling;
+    leave(now(), 0);
+
+    list_g rows;
+    text_g name   = text::make("Name");
+    text_g calls  = text::make("Calls");
+    text_g time   = text::make("Time");
+    text_g gctime = text::make("GCTime");
+    text_g bytes  = text::make("Bytes");
+    if (name && calls && time && gctime && bytes)
+        if (list_g header = list::make(name, calls, time, gctime, bytes))
+            rows = list::make(header);
+
+    while (rows)
+    {
+        // Select the remaining entry with the highest cost
+        profile_cost *best = nullptr;
+        id            cmd  = object::ID_object;
+        for (uint i = 0; i < object::NUM_IDS; i++)
+        {
+            profile_cost &c = p.commands[i];
+            if (c.calls && (!best ||
+                            c.bytes > best->bytes ||
+                            (c.bytes == best->bytes && c.time > best->time)))
+            {
+                best = &c;
+                cmd  = id(i);
+            }
+        }
+        profile_data::named_cost *prog = nullptr;
+        for (uint i = 0; i < p.nprograms; i++)
+        {
+            profile_data::named_cost &c = p.programs[i];
+            if (c.calls && (!best ||
+                            c.bytes > best->bytes ||
+                            (c.bytes == best->bytes && c.time > best->time)))
+            {
+                best = &c;
+                prog = &c;
+            }
+        }
+        if (!best)
+            break;
+
+        object_g label = prog
+            ? object_p(symbol::make(prog->name))
+            : object_p(text::make(object::name(cmd)));
+        integer_g ncalls  = integer::make(best->calls);
+        integer_g ntime   = integer::make(best->time);
+        integer_g ngctime = integer::make(best->gctime);
+        integer_g nbytes  = integer::make(best->bytes);
+        best->calls = 0;
+        if (!label || !ncalls || !ntime || !ngctime || !nbytes)
+        {
+            rows = nullptr;
+            break;
+        }
+        list_g row = list::make(label, ncalls, ntime, ngctime, nbytes);
+        rows = row ? rows->append(object_p(+row)) : nullptr;
+    }
+
+    free(Profiling);
+    Profiling = nullptr;
+    return rows;
+}
+
+
+COMMAND_BODY(Profile)
+// ----------------------------------------------------------------------------
+//   Evaluate an object and return the costs of what it evaluated
+// ----------------------------------------------------------------------------
+{
+    // Start profiling first, so that an error leaves the argument in place
+    if (!rt.top() || !profiler::start())
+        return ERROR;
+    object_g obj = rt.pop();
+
+    // Evaluating a name only pushes the program, so run it here
+    size_t depth = rt.call_depth();
+    result err   = program::run(+obj);
+    if (err == OK && rt.call_depth() > depth)
+        err = program::run_loop(depth);
+
+    list_g rows = profiler::stop();
+    if (err != OK)
+        return err;
+    if (rows && rt.push(+rows))
+        return OK;
+    return ERROR;
+}
@@ -0,0 +1,78 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+// ****************************************************************************
+//  profiler.h                                                    DB48X project
+// ****************************************************************************
+//
+//   File Description:
+//
+//     Attribute execution time, allocations and garbage collection time
+//     to individual commands and named programs
+//
+//     When profiling is active, the program run loop measures each object
+//     it evaluates. Command costs are exclusive, i.e. they do not include
+//     what nested run loops attribute to other commands. Named programs
+//     get the inclusive cost of everything that runs until they return.
+//     When profiling is not active, the run loop is unchanged.
+//
+// ****************************************************************************
+//   (C) 2024 Christophe de Dinechin <christophe@dinechin.org>
+//   This software is licensed under the terms outlined in LICENSE.txt
+// ****************************************************************************
+//   This file is part of DB48X.
+//
+//   DB48X is free software: you can redistribute it and/or modify
+//   it under the terms outlined in the LICENSE.txt file
+//
+//   DB48X is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include "command.h"
+#include "list.h"
+
+
+struct profiler
+// ----------------------------------------------------------------------------
+//   Collect costs for each command and named program
+// ----------------------------------------------------------------------------
+{
+    typedef object::id id;
+
+    struct counters
+    // ------------------------------------------------------------------------
+    //   Running counters used to compute costs
+    // ------------------------------------------------------------------------
+    {
+        uint   time;            // Elapsed time in ms
+        size_t gctime;          // Time spent in the GC in ms
+        size_t bytes;           // Bytes allocated
+    };
+
+    struct sample
+    // ------------------------------------------------------------------------
+    //   Measure the evaluation of one object in the run loop
+    // ------------------------------------------------------------------------
+    {
+        sample();
+        void done(object_r obj);
+
+    private:
+        counters start;         // Counters when the evaluation started
+        counters outer;         // Nested costs in enclosing samples
+        size_t   depth;         // Call depth when the evaluation started
+    };
+
+    static bool start();
+    static list_p stop();
+    // ------------------------------------------------------------------------
+    //   Start and stop profiling, stop returns rows sorted by bytes
+    // ------------------------------------------------------------------------
+
+    static bool active;
+};
+
+COMMAND_DECLARE(Profile,1);             // Evaluate and return profile
+
+#endif // PROFILER_H
@@ -30,6 +30,7 @@
 
 #include "dmcp.h"
 #include "parser.h"
+#include "profiler.h"
 #include "settings.h"
 #include "sysmenu.h"
 #include "tests.h"
@@ -158,6 +159,19 @@ object::result program::run_loop(size_t depth)
 // ----------------------------------------------------------------------------
 //   Continue executing a program
 // ----------------------------------------------------------------------------
+//   Profiling is selected once per loop, so the normal loop has no overhead
+{
+    if (profiler::active)
+        return run_loop<true>(depth);
+    return run_loop<false>(depth);
+}
+
+
+template <bool profiling>
+object::result program::run_loop(size_t depth)
+// ----------------------------------------------------------------------------
+//   Run loop, with or without profiling
+// ----------------------------------------------------------------------------
 //   The 'save_last_args' indicates if we save `LastArgs` at this level
 {
     result   result    = OK;
@@ -168,7 +182,8 @@ object::result program::run_loop(size_t depth)
 
     save<bool> save_running(running, true);
     object_g obj;
-    while ((obj = rt.run_next(depth)))
+    const dispatch *ops = nullptr;
+    while ((obj = rt.run_next(depth, ops)))
     {
         if (interrupted())
         {
@@ -182,7 +197,17 @@ object::result program::run_loop(size_t depth)
         }
         if (last_args)
             rt.need_save();
-        result = obj->evaluate();
+        record(eval, "Evaluating %t", +obj);
+        if (profiling)
+        {
+            profiler::sample sample;
+            result = ops->evaluate(obj);
+            sample.done(obj);
+        }
+        else
+        {
+            result = ops->evaluate(obj);
+        }
 
         if (result != OK)
         {
@@ -210,17 +235,13 @@ object::result program::run_loop(size_t depth)
 
 
 static uint last_interrupted = 0;
-static uint count_interrupted = 0;
 
-bool program::interrupted()
+bool program::poll_interrupt()
 // ----------------------------------------------------------------------------
-//   Return true if the current program must be interrupted
+//   Check the keyboard and busy indicator, return true if interrupted
 // ----------------------------------------------------------------------------
 {
-    if (count_interrupted++ < 32)
-        return halted;
-
-    count_interrupted = 0;
+    polls = 0;
     reset_auto_off();
     uint now = sys_current_ms();
     if (now - last_interrupted >= Settings.BusyIndicatorRefresh())
@@ -287,6 +308,7 @@ EVAL_BODY(block)
 bool program::running = false;
 bool program::halted = false;
 uint program::stepping = 0;
+uint program::polls = 0;
 
 
 COMMAND_BODY(Halt)
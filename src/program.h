@@ -50,12 +50,28 @@ struct program : list
     static result run(algebraic_p alg, bool sync = true);
     INLINE static result run_program(object_p obj)  { return run(obj, false); }
     static result run_loop(size_t depth);
+    template <bool profiling>
+    static result run_loop(size_t depth);
 
-    static bool      interrupted(); // Program interrupted e.g. by EXIT key
     static program_p parse(utf8 source, size_t size);
 
+    static bool interrupted()
+    // ------------------------------------------------------------------------
+    //   Program interrupted e.g. by EXIT key
+    // ------------------------------------------------------------------------
+    //   This is called for every object in the run loop, so only poll
+    //   the keyboard every POLL_PERIOD calls, and keep the test inline
+    {
+        if (polls++ < POLL_PERIOD)
+            return halted;
+        return poll_interrupt();
+    }
+    static bool poll_interrupt();
+
+    enum { POLL_PERIOD = 32 };
     static bool running, halted;
     static uint stepping;
+    static uint polls;
 
   public:
     OBJECT_DECL(program);
@@ -75,6 +75,7 @@ runtime::runtime(byte *mem, size_t size)
       Temporaries(),
       Editing(),
       Scratch(),
+      Appended(),
       Stack(),
       Args(),
       Undo(),
@@ -120,10 +121,12 @@ void runtime::memory(byte *memory, size_t size)
     Globals = LowMem;
     directory_p home = new((void *) Globals) directory();   // Home directory
     *Directories = (object_p) home;             // Current search path
+    ui.user_keys_changed();                     // No user key assignments
     Globals = home->skip();                     // Globals after home
     Temporaries = Globals;                      // Area for temporaries
     Editing = 0;                                // No editor
     Scratch = 0;                                // No scratchpad
+    Appended = nullptr;                         // Nothing to grow
 
     record(runtime, "Memory %p-%p size %u (%uK)",
            LowMem, HighMem, size, size>>10);
@@ -345,21 +348,11 @@ size_t runtime::gc()
                          first, last, Stack, XLibs);
 #endif // SIMULATOR
 
-    object_p *firstobjptr = Stack;
-    object_p *lastobjptr = HighMem;
-
     for (object_p obj = first; obj < last; obj = next)
     {
-        bool found = false;
         next = obj->skip();
         record(gc_details, "Scanning object %p (ends at %p)", obj, next);
-        for (object_p *s = firstobjptr; s < lastobjptr && !found; s++)
-        {
-            found = *s >= obj && *s < next;
-            if (found)
-                record(gc_details, "Found %p at stack level %u",
-                       obj, s - firstobjptr);
-        }
+        bool found = referenced(obj, next);
         if (!found)
         {
             for (gcptr *p = GCSafe; p && !found; p = p->next)
@@ -370,29 +363,6 @@ size_t runtime::gc()
                            obj, p->safe, p);
             }
         }
-        if (!found)
-        {
-            // Check if some of the error information was user-supplied
-            utf8 start = utf8(obj);
-            utf8 end = utf8(next);
-            found = (Error         >= start && Error         < end)
-                ||  (ErrorSave     >= start && ErrorSave     < end)
-                ||  (ErrorSource   >= start && ErrorSource   < end)
-                ||  (ErrorCommand  >= obj   && ErrorCommand  < next)
-                ||  (ui.command    >= start && ui.command    < end)
-                ||  (ui.keymap     >= obj   && ui.keymap     < next);
-            if (!found)
-            {
-                utf8 *label = (utf8 *) &ui.menu_label[0][0];
-                for (uint l = 0; !found && l < ui.NUM_MENUS; l++)
-                    found = label[l] >= start && label[l] < end;
-
-                object_p *functions = &ui.function[0][0];
-                const uint max = sizeof(ui.function)/sizeof(ui.function[0][0]);
-                for (uint k = 0; !found && k < max; k++)
-                    found = functions[k] >= obj && functions[k] < next;
-            }
-        }
 
         if (found)
         {
@@ -406,6 +376,8 @@ size_t runtime::gc()
             recycled += next - obj;
             record(gc_details, "Recycling %p size %u total %u",
                    obj, next - obj, recycled);
+            if (Appended >= obj && Appended < next)
+                Appended = nullptr;
         }
     }
 
@@ -452,6 +424,47 @@ size_t runtime::gc()
 }
 
 
+bool runtime::referenced(object_p obj, object_p next) const
+// ----------------------------------------------------------------------------
+//   Check if the RPL stacks or the user interface refer to an object
+// ----------------------------------------------------------------------------
+//   This does not include GC-safe pointers, which only the GC considers
+{
+    for (object_p *s = Stack; s < HighMem; s++)
+    {
+        if (*s >= obj && *s < next)
+        {
+            record(gc_details, "Found %p at stack level %u", obj, s - Stack);
+            return true;
+        }
+    }
+
+    // Check if some of the error information was user-supplied
+    utf8 start = utf8(obj);
+    utf8 end = utf8(next);
+    if ((Error        >= start && Error        < end)  ||
+        (ErrorSave    >= start && ErrorSave    < end)  ||
+        (ErrorSource  >= start && ErrorSource  < end)  ||
+        (ErrorCommand >= obj   && ErrorCommand < next) ||
+        (ui.command   >= start && ui.command   < end)  ||
+        (ui.keymap    >= obj   && ui.keymap    < next))
+        return true;
+
+    utf8 *label = (utf8 *) &ui.menu_label[0][0];
+    for (uint l = 0; l < ui.NUM_MENUS; l++)
+        if (label[l] >= start && label[l] < end)
+            return true;
+
+    object_p *functions = &ui.function[0][0];
+    const uint max = sizeof(ui.function)/sizeof(ui.function[0][0]);
+    for (uint k = 0; k < max; k++)
+        if (functions[k] >= obj && functions[k] < next)
+            return true;
+
+    return false;
+}
+
+
 void runtime::move(object_p to, object_p from,
                    size_t size, size_t overscan, bool scratch)
 // ----------------------------------------------------------------------------
@@ -532,6 +545,10 @@ void runtime::move(object_p to, object_p from,
     if (ui.keymap >= from && ui.keymap < last)
         ui.keymap = list_p(object_p(ui.keymap) + delta);
 
+    // Adjust the last appended object
+    if (Appended >= from && Appended < last)
+        Appended += delta;
+
     // Adjust functions
     object_p *functions = &ui.function[0][0];
     const uint max = sizeof(ui.function) / sizeof(ui.function[0][0]);
@@ -817,6 +834,37 @@ byte *runtime::append_expression(object_p obj)
 }
 
 
+object_p runtime::grow(object_p obj, size_t extra, const gcptr &owner)
+// ----------------------------------------------------------------------------
+//   Grow the last appended object in place if nothing else refers to it
+// ----------------------------------------------------------------------------
+//   This is only possible for the last object built by appending, which is
+//   known to be a temporary that is not inside another object, and only if
+//   nothing on the RPL stacks, in the user interface or in a GC-safe pointer
+//   other than owner refers to it. Temporaries allocated after obj, such as
+//   loop counters, the editor and scratchpad move up, like for move_globals.
+//   The caller is responsible for writing the extra bytes and the new size.
+{
+    if (!obj || obj != Appended || available() < extra)
+        return nullptr;
+    object_p next = obj->skip();
+    if (referenced(obj, next))
+        return nullptr;
+    for (gcptr *p = GCSafe; p; p = p->next)
+        if (p != &owner && p->safe >= (byte *) obj && p->safe < (byte *) next)
+            return nullptr;
+
+    size_t moving = (byte *) Temporaries - (byte *) next + Editing + Scratch;
+    move(object_p((byte *) next + extra), next, moving, 1);
+    Temporaries = object_p((byte *) Temporaries + extra);
+
+    // A cleaner may have saved a position that is now inside obj
+    GCUnclear++;
+    record(runtime, "Grew %p by %u bytes, moved %u", obj, extra, moving);
+    return obj;
+}
+
+
 object_p runtime::clone(object_p source)
 // ----------------------------------------------------------------------------
 //   Clone an object into the temporaries area
@@ -1368,6 +1416,7 @@ bool runtime::enter(directory_p dir)
 
     // Update directory
     *Directories = dir;
+    ui.user_keys_changed();
 
     return true;
 }
@@ -1396,6 +1445,7 @@ bool runtime::updir(size_t count)
     size_t moving = Directories - Stack;
     for (size_t i = 0; i < moving; i++)
         *(--newp) = *(--oldp);
+    ui.user_keys_changed();
 
     return true;
 }
@@ -1911,6 +1961,10 @@ object_p cleaner::adjust(object_p temp)
                rt.Temporaries, temporaries + sz);
         rt.GCCleared += temp - temporaries;
         memmove((void *) temporaries, temp, sz);
+        if (rt.Appended == temp)
+            rt.Appended = temporaries;
+        else if (rt.Appended >= temporaries)
+            rt.Appended = nullptr;
         temp = temporaries;
         rt.Temporaries = temp + sz;
     }
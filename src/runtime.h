@@ -157,6 +157,33 @@ struct runtime
     //   Make a new temporary of the given size
     // ------------------------------------------------------------------------
 
+    struct gcptr;
+    object_p grow(object_p obj, size_t extra, const gcptr &owner);
+    // ------------------------------------------------------------------------
+    //   Grow the last appended object in place if nothing else refers to it
+    // ------------------------------------------------------------------------
+
+    void appended(object_p obj)
+    // ------------------------------------------------------------------------
+    //   Record a new temporary built by appending, that may grow in place
+    // ------------------------------------------------------------------------
+    {
+        Appended = obj;
+    }
+
+    bool growable(object_p obj) const
+    // ------------------------------------------------------------------------
+    //   Check if an object is the last temporary built by appending
+    // ------------------------------------------------------------------------
+    {
+        return obj && obj == Appended;
+    }
+
+    bool referenced(object_p obj, object_p next) const;
+    // ------------------------------------------------------------------------
+    //   Check if the RPL stacks or user interface refer to an object
+    // ------------------------------------------------------------------------
+
     object_p clone(object_p source);
     // ------------------------------------------------------------------------
     //   Clone an object into the temporaries area
@@ -297,6 +324,34 @@ struct runtime
     // ------------------------------------------------------------------------
 
 
+    size_t gc_cycles() const
+    // ------------------------------------------------------------------------
+    //   Number of garbage collection cycles so far
+    // ------------------------------------------------------------------------
+    {
+        return GCCycles;
+    }
+
+
+    size_t gc_duration() const
+    // ------------------------------------------------------------------------
+    //   Total time spent in the garbage collector, in milliseconds
+    // ------------------------------------------------------------------------
+    {
+        return GCDuration;
+    }
+
+
+    size_t allocated_bytes() const
+    // ------------------------------------------------------------------------
+    //   Running total of bytes allocated for temporaries, for measurements
+    // ------------------------------------------------------------------------
+    //   Live temporaries plus what the garbage collector and cleaner removed
+    {
+        return (byte_p) Temporaries - (byte_p) Globals + GCPurged + GCCleared;
+    }
+
+
     void move(object_p to, object_p from,
               size_t sz, size_t overscan = 0, bool scratch=false);
     // ------------------------------------------------------------------------
@@ -532,6 +587,17 @@ struct runtime
     //   Getting proper inlining here is important for performance, but
     //   that requires the definition of object::skip()
 #ifdef OBJECT_H
+    {
+        const object::dispatch *ops = nullptr;
+        return run_next(depth, ops);
+    }
+
+    inline object_p run_next(size_t depth, const object::dispatch *&ops)
+    // ------------------------------------------------------------------------
+    //   Pull the next object to execute, also returning its handlers
+    // ------------------------------------------------------------------------
+    //   The type of the object is decoded only once, and the caller can
+    //   directly dispatch to the `evaluate` handler without decoding again
     {
         object_p *high = HighMem - depth;
         while (Returns < high)
@@ -542,7 +608,8 @@ struct runtime
             {
                 if (next)
                 {
-                    object_p nnext = next->skip();
+                    ops = &next->ops();
+                    object_p nnext = next + ops->size(next);
                     Returns[0] = nnext;
                     if (nnext >= end)
                     {
@@ -570,13 +637,15 @@ struct runtime
 #  pragma GCC pop_options
 #endif // DM42
 
-    object_p run_stepping()
+    object_p run_stepping(size_t frame = 0)
     // ------------------------------------------------------------------------
     //   Return the next instruction for single-stepping
     // ------------------------------------------------------------------------
+    //   Frames other than 0 return the next instruction in outer frames
     {
-        if (Returns < HighMem)
-            return Returns[0];
+        object_p *ptr = Returns + 2 * frame;
+        if (ptr < HighMem)
+            return ptr[0];
         return nullptr;
     }
 
@@ -1006,6 +1075,7 @@ protected:
     object_p  Temporaries;  // Temporaries (must be valid objects)
     size_t    Editing;      // Text editor (utf8 encoded)
     size_t    Scratch;      // Scratch pad (may be invalid objects)
+    object_p  Appended;     // Last appended temporary, may grow in place
     object_p *Stack;        // Top of user stack
     object_p *Args;         // Start of save area for last arguments
     object_p *Undo;         // Start of undo stack
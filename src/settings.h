@@ -310,6 +310,9 @@ ularge setting_value<ularge>(object_p obj, ularge init);
 template <>
 int setting_value<int>(object_p obj, int init);
 
+template <>
+int16_t setting_value<int16_t>(object_p obj, int16_t init);
+
 template <>
 object::id setting_value<object::id>(object_p obj, object::id init);
 
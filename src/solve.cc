@@ -33,6 +33,7 @@
 #include "arithmetic.h"
 #include "array.h"
 #include "compare.h"
+#include "compiled.h"
 #include "equations.h"
 #include "expression.h"
 #include "functions.h"
@@ -46,6 +47,9 @@
 #include "unit.h"
 #include "variables.h"
 
+#include <cfloat>
+#include <cmath>
+
 RECORDER(solve, 16, "Numerical solver");
 RECORDER(solve_error, 16, "Numerical solver errors");
 
@@ -96,6 +100,156 @@ static algebraic_p recall(algebraic_r namer)
     return nullptr;
 }
 
+uint Root::hardware_iterations = 0;
+uint Root::decimal_iterations  = 0;
+
+
+static bool brent_root(const compiled_function &fn,
+                       double a, double fa, double b, double fb,
+                       double &lo, double &hi, uint max, uint &iterations)
+// ----------------------------------------------------------------------------
+//   Brent's method with hardware floating-point, from a sign change in [a,b]
+// ----------------------------------------------------------------------------
+{
+    double c  = b;
+    double fc = fb;
+    double d  = b - a;
+    double e  = d;
+    while (iterations < max && !program::interrupted())
+    {
+        if ((fb > 0 && fc > 0) || (fb < 0 && fc < 0))
+        {
+            c  = a;
+            fc = fa;
+            d  = e = b - a;
+        }
+        if (std::fabs(fc) < std::fabs(fb))
+        {
+            a  = b;
+            b  = c;
+            c  = a;
+            fa = fb;
+            fb = fc;
+            fc = fa;
+        }
+
+        double tol = 2 * DBL_EPSILON * std::fabs(b) + DBL_MIN;
+        double m   = 0.5 * (c - b);
+        if (std::fabs(m) <= tol || fb == 0)
+        {
+            lo = b;
+            hi = c;
+            return true;
+        }
+
+        if (std::fabs(e) >= tol && std::fabs(fa) > std::fabs(fb))
+        {
+            // Try inverse quadratic interpolation, or secant if a == c
+            double s = fb / fa;
+            double p, q;
+            if (a == c)
+            {
+                p = 2 * m * s;
+                q = 1 - s;
+            }
+            else
+            {
+                double r = fb / fc;
+                q = fa / fc;
+                p = s * (2 * m * q * (q - r) - (b - a) * (r - 1));
+                q = (q - 1) * (r - 1) * (s - 1);
+            }
+            if (p > 0)
+                q = -q;
+            else
+                p = -p;
+            if (2 * p < std::min(3 * m * q - std::fabs(tol * q),
+                                 std::fabs(e * q)))
+            {
+                e = d;
+                d = p / q;
+            }
+            else
+            {
+                d = e = m;                      // Interpolation failed
+            }
+        }
+        else
+        {
+            d = e = m;                          // Bounds decrease too slowly
+        }
+
+        a  = b;
+        fa = fb;
+        b += std::fabs(d) > tol ? d : m > 0 ? tol : -tol;
+        if (!fn.run(b, fb))
+            return false;
+        iterations++;
+    }
+    return false;
+}
+
+
+static bool hardware_root(const compiled_function &fn,
+                          double &lo, double &hi, double &ylo,
+                          uint max, uint &iterations)
+// ----------------------------------------------------------------------------
+//   Find a root with hardware floating-point, return two points close to it
+// ----------------------------------------------------------------------------
+//   This uses the secant method, or Brent's method once there is a sign
+//   change if BrentSolver is set. It returns false if any value is not
+//   finite or if it does not converge, letting the decimal solver start
+//   from the initial guesses.
+{
+    double x0 = lo;
+    double x1 = hi;
+    double y0 = 0.0;
+    double y1 = 0.0;
+    bool   brent = Settings.BrentSolver();
+
+    if (x1 == x0)
+        x1 = x0 ? x0 * (1234.0 / 997.0) : 1234.0 / 997.0;
+    if (!fn.run(x0, y0) || !fn.run(x1, y1))
+        return false;
+    ylo = y0;
+    iterations = 2;
+
+    while (iterations < max && !program::interrupted())
+    {
+        if (y1 == 0)
+        {
+            x0 = x1 * (1 + 4 * DBL_EPSILON) + DBL_MIN;
+            break;
+        }
+        if (brent && ((y0 < 0 && y1 > 0) || (y0 > 0 && y1 < 0)))
+            return brent_root(fn, x0, y0, x1, y1, lo, hi, max, iterations);
+        if (y1 == y0)
+            return false;
+
+        double x2 = x1 - y1 * (x1 - x0) / (y1 - y0);
+        double y2 = 0.0;
+        if (!std::isfinite(x2) || !fn.run(x2, y2))
+            return false;
+        iterations++;
+        x0 = x1;
+        y0 = y1;
+        x1 = x2;
+        y1 = y2;
+        if (std::fabs(x1 - x0) <= 4 * DBL_EPSILON * std::fabs(x1))
+            break;
+    }
+    if (iterations >= max)
+        return false;
+
+    // The decimal solver needs two distinct points to interpolate
+    if (x0 == x1)
+        x0 = x1 * (1 + 1024 * DBL_EPSILON) + DBL_MIN;
+    lo = x1;
+    hi = x0;
+    return true;
+}
+
+
 algebraic_p Root::solve(program_r pgm, algebraic_r goal, algebraic_r guess)
 // ----------------------------------------------------------------------------
 //   The core of the solver, numerical solving for a single variable
@@ -215,9 +369,53 @@ algebraic_p Root::solve(program_r pgm, algebraic_r goal, algebraic_r guess)
     uint             max         = Settings.SolverIterations();
     algebraic_g      two         = integer::make(2);
     int              degraded    = 0;
+    bool             refine      = false;
+
+    // Use hardware floating-point code if it is precise enough
+    compiled_function fn(eq, Settings.Precision());
+
+    // In mixed precision mode, get close to the root with hardware FP first
+    hardware_iterations = 0;
+    decimal_iterations  = 0;
+    if (Settings.MixedPrecisionSolver() && !uexpr && !is_complex)
+    {
+        compiled_function hw(eq);
+        double            lo  = 0.0;
+        double            hi  = 0.0;
+        double            ylo = 0.0;
+        if (hw.compiled() &&
+            compiled_function::as_double(lx, lo) &&
+            compiled_function::as_double(hx, hi) &&
+            hardware_root(hw, lo, hi, ylo, max, hardware_iterations))
+        {
+            // Keep the tolerance relative to the value at the initial guess
+            if (ylo != 0.0)
+                if (algebraic_g neps =
+                    compiled_function::from_double(std::fabs(ylo)) * yeps)
+                    if (smaller_magnitude(yeps, neps))
+                        yeps = neps;
+
+            algebraic_g nlx = compiled_function::from_double(lo);
+            algebraic_g nhx = compiled_function::from_double(hi);
+            if (nlx && nhx)
+            {
+                // lx is close to the root, use plain secant steps from it
+                lx     = nlx;
+                hx     = nhx;
+                x      = lx;
+                refine = true;
+            }
+        }
+        record(solve, "Hardware FP iterations %u, starting at %t [%t, %t]",
+               hardware_iterations, +x, +lx, +hx);
+        if (rt.error())
+            return nullptr;
+    }
 
     for (uint i = 0; i < max && !program::interrupted(); i++)
     {
+        decimal_iterations = i + 1;
+
         // If we failed during evaluation of x, break
         if (!x)
         {
@@ -234,7 +432,7 @@ algebraic_p Root::solve(program_r pgm, algebraic_r goal, algebraic_r guess)
         }
 
         // Evaluate equation
-        y = algebraic::evaluate_function(eq, x);
+        y = fn.evaluate(x);
 
         // If the function evaluates as 10^23 and eps=10^-18, use 10^(23-18)
         if (!i && y && !y->is_zero())
@@ -387,7 +585,7 @@ algebraic_p Root::solve(program_r pgm, algebraic_r goal, algebraic_r guess)
                     record(solve, "[%u] Moving to %t - %t * %t / %t",
                            i, +lx, +y, +dx, +dy);
                     is_constant = false;
-                    x = lx - (y / dy) * dx;
+                    x = lx - ((refine ? ly : y) / dy) * dx;
                     record(solve, "[%u] Moved to %t [%t, %t]",
                            i, +x, +lx, +hx);
                 }
@@ -555,6 +753,427 @@ algebraic_p Root::solve(algebraic_g &eq,
 }
 
 
+static algebraic_p newton_value(algebraic_r value)
+// ----------------------------------------------------------------------------
+//   Reduce a value to a number, converting units to base SI units
+// ----------------------------------------------------------------------------
+{
+    algebraic_g v = value;
+    if (v && unit::get(v))
+    {
+        save<bool> ueval(unit::mode, true);
+        v = v->evaluate();
+        if (unit_p u = unit::get(v))
+            v = u->value();
+    }
+    if (!v || (!v->is_real() && !v->is_complex()))
+    {
+        if (!rt.error())
+            rt.invalid_function_error();
+        return nullptr;
+    }
+    return v;
+}
+
+
+static bool newton_store(symbol_r name, algebraic_r x, algebraic_r uexpr)
+// ----------------------------------------------------------------------------
+//   Store the current value of a variable with its unit
+// ----------------------------------------------------------------------------
+{
+    algebraic_g value = uexpr ? unit::simple(x, uexpr) : +x;
+    return value && directory::store_here(name, value);
+}
+
+
+static bool lu_solve(algebraic_g *a, algebraic_g *b, size_t n)
+// ----------------------------------------------------------------------------
+//   Solve a.x = b in place, a being a packed n x n matrix, x replacing b
+// ----------------------------------------------------------------------------
+//   This is an LU decomposition with partial pivoting, L replacing the
+//   lower part of a, U its upper part
+{
+    for (size_t k = 0; k < n; k++)
+    {
+        size_t      p    = k;
+        algebraic_g pmag = abs::run(a[k * n + k]);
+        for (size_t i = k + 1; i < n && pmag; i++)
+        {
+            algebraic_g mag = abs::run(a[i * n + k]);
+            if (!mag)
+                return false;
+            if (smaller_magnitude(pmag, mag))
+            {
+                p    = i;
+                pmag = mag;
+            }
+        }
+        if (!pmag || pmag->is_zero(false))
+            return false;
+        if (p != k)
+        {
+            for (size_t j = 0; j < n; j++)
+            {
+                algebraic_g t = a[k * n + j];
+                a[k * n + j] = a[p * n + j];
+                a[p * n + j] = t;
+            }
+            algebraic_g t = b[k];
+            b[k] = b[p];
+            b[p] = t;
+        }
+        for (size_t i = k + 1; i < n; i++)
+        {
+            algebraic_g l = a[i * n + k] / a[k * n + k];
+            a[i * n + k] = l;
+            for (size_t j = k + 1; j < n; j++)
+                a[i * n + j] = a[i * n + j] - l * a[k * n + j];
+            b[i] = b[i] - l * b[k];
+            if (!b[i])
+                return false;
+        }
+    }
+    for (size_t k = n; k-- > 0; )
+    {
+        algebraic_g sum = b[k];
+        for (size_t j = k + 1; j < n && sum; j++)
+            sum = sum - a[k * n + j] * b[j];
+        b[k] = sum / a[k * n + k];
+        if (!b[k])
+            return false;
+    }
+    return true;
+}
+
+
+static bool newton_solver(list_r eqns, list_r vars, list_r guesses, size_t n)
+// ----------------------------------------------------------------------------
+//   Solve n coupled equations for n variables with Newton-Raphson
+// ----------------------------------------------------------------------------
+//   The Jacobian is computed symbolically once, and evaluated at each step.
+//   Entries that cannot be differentiated use finite differences.
+//   Values with units are reduced to base SI units, and each variable is
+//   iterated on in the unit of its name or of its initial guess.
+{
+    enum { MAX_UNKNOWNS = 16 };
+    if (n > MAX_UNKNOWNS)
+    {
+        rt.multisolver_variable_error();
+        return false;
+    }
+
+    symbol_g     syms[n];
+    algebraic_g  uexprs[n];
+    algebraic_g  x[n];
+    algebraic_g  r[n];
+    algebraic_g  yeps[n];
+    expression_g f[n];
+    expression_g df[n * n];
+    algebraic_g  jac[n * n];
+
+    settings::PrepareForFunctionEvaluation willEvaluateFunctions;
+    settings::SaveNumericalConstants       snc(true);
+    save<bool>                             nodates(unit::nodates, true);
+
+    // Variables and initial values, in the unit of the variable if any
+    list::iterator vi = vars->begin();
+    list::iterator gi = guesses->begin();
+    for (size_t j = 0; j < n; j++, ++vi, ++gi)
+    {
+        algebraic_g varobj = algebraic_p(*vi);
+        while (unit_p u = unit::get(varobj))
+        {
+            varobj    = u->value();
+            uexprs[j] = u->uexpr();
+        }
+        syms[j] = varobj->as_quoted<symbol>();
+        if (!syms[j])
+        {
+            rt.type_error();
+            return false;
+        }
+        algebraic_g guess = algebraic_p(*gi);
+        if (guess->is_array_or_list())
+            guess = guess->algebraic_child(0);
+        if (!guess)
+        {
+            rt.type_error();
+            return false;
+        }
+        if (unit_g gu = unit::get(guess))
+        {
+            if (uexprs[j])
+            {
+                algebraic_g one = integer::make(1);
+                unit_g      target = unit::make(one, uexprs[j]);
+                if (!target || !target->convert(gu))
+                    return false;
+            }
+            else
+            {
+                uexprs[j] = gu->uexpr();
+            }
+            guess = gu->value();
+        }
+
+        // Iterate with decimal values, exact fractions would grow quickly
+        if (!algebraic::to_decimal(guess))
+            return false;
+        x[j] = guess;
+    }
+
+    // Equations as differences, and their symbolic partial derivatives
+    list::iterator ei = eqns->begin();
+    for (size_t i = 0; i < n; i++, ++ei)
+    {
+        expression_g eq = expression::get(*ei);
+        if (!eq)
+        {
+            rt.type_error();
+            return false;
+        }
+        if (expression_g diff = eq->as_difference_for_solve())
+            eq = diff;
+        f[i] = eq;
+        for (size_t j = 0; j < n; j++)
+        {
+            // Unknowns with a stored value must not be replaced by it
+            save<bool>   symbolic(unit::factoring, true);
+            expression_g d       = eq->derivative(syms[j]);
+            bool         unknown = !d;
+            if (d)
+                for (object_p obj : *d)
+                    if (obj->type() == object::ID_Derivative)
+                        unknown = true;
+            if (unknown)
+                rt.clear_error();
+            else
+                df[i * n + j] = d;
+        }
+    }
+
+    int         prec    = Settings.Precision() - Settings.SolverImprecision();
+    algebraic_g eps     = decimal::make(1, prec <= 0 ? -1 : -prec);
+    algebraic_g hstep   = decimal::make(1, -int(Settings.Precision() / 2));
+    uint        max     = Settings.SolverIterations();
+    for (uint iter = 0; iter < max && !program::interrupted(); iter++)
+    {
+        // Evaluate residuals at the current point
+        bool converged = true;
+        for (size_t j = 0; j < n; j++)
+            if (!newton_store(syms[j], x[j], uexprs[j]))
+                return false;
+        for (size_t i = 0; i < n; i++)
+        {
+            r[i] = newton_value(f[i]->evaluate());
+            if (!r[i])
+                return false;
+            if (!iter)
+            {
+                // Tolerance relative to the initial residual, as in Root
+                yeps[i] = eps;
+                if (algebraic_g neps = abs::run(r[i]) * eps)
+                    if (smaller_magnitude(eps, neps))
+                        yeps[i] = neps;
+            }
+            if (!r[i]->is_zero(false) && !smaller_magnitude(r[i], yeps[i]))
+                converged = false;
+        }
+        record(solve, "Newton [%u] r0=%t x0=%t", iter, +r[0], +x[0]);
+        if (converged)
+            return true;
+
+        // Evaluate the Jacobian
+        for (size_t i = 0; i < n; i++)
+        {
+            for (size_t j = 0; j < n; j++)
+            {
+                algebraic_g v;
+                if (df[i * n + j])
+                {
+                    v = df[i * n + j]->evaluate();
+                    if (v && uexprs[j])
+                        v = v * unit::simple(integer::make(1), uexprs[j]);
+                    v = v ? newton_value(v) : nullptr;
+                    if (!v)
+                    {
+                        rt.clear_error();
+                        df[i * n + j] = nullptr;
+                    }
+                }
+                jac[i * n + j] = v;
+            }
+        }
+
+        // Use finite differences for entries we could not differentiate
+        for (size_t j = 0; j < n; j++)
+        {
+            bool needed = false;
+            for (size_t i = 0; i < n; i++)
+                if (!jac[i * n + j])
+                    needed = true;
+            if (!needed)
+                continue;
+
+            algebraic_g h  = x[j]->is_zero(false)
+                ? hstep
+                : abs::run(x[j]) * hstep;
+            algebraic_g xh = x[j] + h;
+            if (!xh || !newton_store(syms[j], xh, uexprs[j]))
+                return false;
+            for (size_t i = 0; i < n; i++)
+            {
+                if (jac[i * n + j])
+                    continue;
+                algebraic_g rh = newton_value(f[i]->evaluate());
+                if (!rh)
+                    return false;
+                jac[i * n + j] = (rh - r[i]) / h;
+                if (!jac[i * n + j])
+                    return false;
+            }
+            if (!newton_store(syms[j], x[j], uexprs[j]))
+                return false;
+        }
+
+        // Solve J.dx = -r and update x
+        for (size_t i = 0; i < n; i++)
+            r[i] = -r[i];
+        if (!lu_solve(jac, r, n))
+        {
+            if (!rt.error())
+                rt.no_solution_error();
+            return false;
+        }
+        bool small = true;
+        for (size_t j = 0; j < n; j++)
+        {
+            algebraic_g nx = x[j] + r[j];
+            if (!nx)
+                return false;
+            if (!r[j]->is_zero(false))
+            {
+                algebraic_g xeps = abs::run(nx) * eps;
+                if (!xeps || !smaller_magnitude(r[j], xeps))
+                    small = false;
+            }
+            x[j] = nx;
+        }
+        if (small)
+        {
+            for (size_t j = 0; j < n; j++)
+                if (!newton_store(syms[j], x[j], uexprs[j]))
+                    return false;
+            return true;
+        }
+    }
+
+    rt.no_solution_error();
+    return false;
+}
+
+
+static symbol_p unknown_name(object_p obj)
+// ----------------------------------------------------------------------------
+//   Return the name of an unknown, which may have a unit
+// ----------------------------------------------------------------------------
+{
+    while (unit_p u = unit::get(obj))
+        obj = u->value();
+    return obj->as_quoted<symbol>();
+}
+
+
+static bool coupled(expression_r eq, list_r vars, size_t v)
+// ----------------------------------------------------------------------------
+//   Check if an equation involves an unknown other than the one at index v
+// ----------------------------------------------------------------------------
+//   This only depends on the names in the equation, not on the values
+//   currently stored in the unknowns, e.g. by a previous solve.
+{
+    list_g names = eq->names();
+    if (!names)
+        return false;
+    size_t ov = 0;
+    for (object_p obj : *vars)
+        if (ov++ != v)
+            if (symbol_p ovar = unknown_name(obj))
+                for (object_p name : *names)
+                    if (symbol_p nsym = name->as<symbol>())
+                        if (ovar->is_same_as(nsym))
+                            return true;
+    return false;
+}
+
+
+static bool residuals_ok(list_r eqs, list_r unused)
+// ----------------------------------------------------------------------------
+//   Check that the values found satisfy the equations used to find them
+// ----------------------------------------------------------------------------
+//   The tolerance is looser than for a single solve, since it only needs to
+//   catch values that are not a solution of the system at all.
+{
+    settings::PrepareForFunctionEvaluation willEvaluateFunctions;
+    settings::SaveNumericalConstants       snc(true);
+    save<bool>                             nodates(unit::nodates, true);
+
+    int         prec = (Settings.Precision() - Settings.SolverImprecision()) / 2;
+    algebraic_g eps  = decimal::make(1, prec <= 0 ? -1 : -prec);
+    for (object_p obj : *eqs)
+    {
+        bool skip = false;
+        for (object_p left : *unused)
+            if (left->is_same_as(obj))
+                skip = true;
+        if (skip)
+            continue;
+
+        expression_g eq = expression::get(obj);
+        if (!eq)
+            return false;
+
+        // Compare relative to the size of both sides, in the unit of the
+        // left side, since affine units like °C do not convert to base units
+        expression_g l, r;
+        algebraic_g  res, tol;
+        if (eq->split_equation(l, r))
+        {
+            algebraic_g lv = l->evaluate();
+            algebraic_g rv = lv ? r->evaluate() : nullptr;
+            res = rv ? lv - rv : nullptr;
+            tol = res ? abs::run(lv) + abs::run(rv) : nullptr;
+        }
+        else
+        {
+            res = eq->evaluate();
+            tol = res ? abs::run(res) : nullptr;
+        }
+        if (unit_p u = unit::get(res))
+            res = u->value();
+        if (unit_p u = unit::get(tol))
+            tol = u->value();
+        if (!res || !tol ||
+            (!res->is_real() && !res->is_complex()) || !tol->is_real())
+        {
+            if (!rt.error())
+                rt.invalid_function_error();
+            return false;
+        }
+        algebraic_g one = integer::make(1);
+        tol = (tol + one) * eps;
+        if (!tol)
+            return false;
+        record(solve, "Residual %t tolerance %t", +res, +tol);
+        if (!res->is_zero(false) && !smaller_magnitude(res, tol))
+        {
+            rt.no_solution_error();
+            return false;
+        }
+    }
+    return true;
+}
+
+
 list_p Root::multiple_equation_solver(list_r eqs, list_r names, list_r guesses)
 // ----------------------------------------------------------------------------
 //   Solve multiple equations in sequence (equivalent to HP's MES)
@@ -645,9 +1264,8 @@ list_p Root::multiple_equation_solver(list_r eqs, list_r names, list_r guesses)
             }
             list::iterator ei = eqns->begin();
             expression_g   best;
-            uint           bestvars = ~0U;
-            size_t         bestidx  = 0;
-            for (size_t e = 0; !found && e < ecount && bestvars; e++)
+            size_t         bestidx = 0;
+            for (size_t e = 0; !best && e < ecount; e++)
             {
                 expression_g eq = expression::get(*ei);
                 if (!eq)
@@ -656,24 +1274,12 @@ list_p Root::multiple_equation_solver(list_r eqs, list_r names, list_r guesses)
                         rt.type_error();
                     return nullptr;
                 }
-                if (eq->is_well_defined(var, false))
+
+                // Only solve an equation alone if no other unknown is in it
+                if (eq->is_well_defined(var, false) && !coupled(eq, vars, v))
                 {
-                    list::iterator ovi    = vars->begin();
-                    uint           wdvars = 0;
-                    for (size_t ov = 0; ov < vcount; ov++)
-                    {
-                        if (ov != v)
-                            if (symbol_g ovar = (*ovi)->as_quoted<symbol>())
-                                if (eq->is_well_defined(ovar, false, var))
-                                    wdvars++;
-                        ++ovi;
-                    }
-                    if (wdvars < bestvars)
-                    {
-                        best     = eq;
-                        bestvars = wdvars;
-                        bestidx  = e;
-                    }
+                    best    = eq;
+                    bestidx = e;
                 }
                 ++ei;
             }
@@ -703,6 +1309,17 @@ list_p Root::multiple_equation_solver(list_r eqs, list_r names, list_r guesses)
             ++gi;
         }
 
+        // Remaining equations are coupled, solve them simultaneously
+        if (!found && ecount == vcount)
+        {
+            if (!newton_solver(eqns, vars, gvalues, vcount))
+            {
+                solver_command_error();
+                return nullptr;
+            }
+            break;
+        }
+
         // This algorithm does not apply, some variables were not found
         if (!found)
         {
@@ -712,6 +1329,13 @@ list_p Root::multiple_equation_solver(list_r eqs, list_r names, list_r guesses)
         }
     }
 
+    // Check that the sequential solves did not stop on a wrong point
+    if (!residuals_ok(eqs, eqns))
+    {
+        solver_command_error();
+        return nullptr;
+    }
+
     list_g result = names->map(recall);
     return result;
 }
@@ -743,6 +1367,29 @@ NFUNCTION_BODY(Root)
 }
 
 
+COMMAND_BODY(SolverStatistics)
+// ----------------------------------------------------------------------------
+//   Return the number of iterations of the last numerical solving
+// ----------------------------------------------------------------------------
+{
+    tag_g hw  = tag::make("Hardware", integer::make(Root::hardware_iterations));
+    tag_g dec = tag::make("Decimal",  integer::make(Root::decimal_iterations));
+    if (hw && dec)
+    {
+        scribble scr;
+        if (rt.append(hw) && rt.append(dec))
+        {
+            size_t  sz   = scr.growth();
+            gcbytes data = scr.scratch();
+            if (array_p a = rt.make<array>(ID_array, data, sz))
+                if (rt.push(a))
+                    return OK;
+        }
+    }
+    return ERROR;
+}
+
+
 NFUNCTION_BODY(MultipleEquationsSolver)
 // ----------------------------------------------------------------------------
 //   Solve a set of equations one at a time
@@ -48,6 +48,8 @@ NFUNCTION(Root,3,
           static list_p multiple_equation_solver(list_r eqs,
                                                  list_r names,
                                                  list_r guesses);
+          static uint hardware_iterations;
+          static uint decimal_iterations;
     );
 NFUNCTION(MultipleEquationsSolver,3,
           static bool can_be_symbolic(uint a)
@@ -56,6 +58,7 @@ NFUNCTION(MultipleEquationsSolver,3,
           }
 );
 COMMAND_DECLARE(MultipleEquationsRoots, 1);
+COMMAND_DECLARE(SolverStatistics, 0);
 
 
 COMMAND_DECLARE(StEq, 1);
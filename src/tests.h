@@ -57,6 +57,28 @@ struct tests
     // Run all tests
     void run(uint onlyCurrent);
 
+    // Run RPL source files, e.g. benchmarks from the library
+    void run_files(uint nfiles, cstring files[], uint timeout);
+
+    // Run the built-in benchmark suite and write CSV to stdout
+    void run_benchmark(uint iterations, uint timeout);
+
+    // Number of failures in the last run
+    uint failed() const { return failures.size(); }
+
+    // Run categories picked one at a time, e.g. by parallel workers
+    typedef int (*next_category_fn)(void *arg);
+    void run_categories(next_category_fn next, void *arg);
+
+    // Transfer results between processes and merge them
+    void export_results(FILE *out);
+    bool import_results(FILE *in);
+
+    // All test categories
+    typedef void (tests::*category)();
+    static const category categories[];
+    static const uint     num_categories;
+
     // Individual test categories
     void reset_settings();
     void shift_logic();
@@ -116,6 +138,7 @@ struct tests
     void graphic_commands();
     void hms_dms_operations();
     void date_operations();
+    void profiling_operations();
     void infinity_and_undefined();
     void overflow_and_underflow();
     void online_help();
@@ -117,6 +117,37 @@ RENDER_BODY(text)
 }
 
 
+text_g text::append(text_r x, gcbytes data, size_t len)
+// ----------------------------------------------------------------------------
+//   Append bytes to a text or list, growing it in place if possible
+// ----------------------------------------------------------------------------
+//   When x is the result of the previous append, is the last temporary and
+//   nothing but x refers to it, it can grow in place, as long as its length
+//   keeps the same size. Otherwise, build the result with a single copy.
+{
+    size_t sx = 0;
+    x->value(&sx);
+    size_t sz = sx + len;
+    if (leb128size(sz) == leb128size(sx) && rt.grow(+x, len, x))
+    {
+        byte *p = (byte *) x->payload();
+        p = leb128(p, sz);
+        memmove(p + sx, +data, len);
+        return x;
+    }
+
+    gcutf8 tx     = x->value();
+    text_g concat = rt.make<text>(x->type(), tx, sz);
+    if (concat)
+    {
+        byte *p = (byte *) concat->value();
+        memmove(p + sx, +data, len);
+        rt.appended(+concat);
+    }
+    return concat;
+}
+
+
 text_g operator+(text_r x, text_r y)
 // ----------------------------------------------------------------------------
 //   Concatenate two texts or lists
@@ -126,17 +157,9 @@ text_g operator+(text_r x, text_r y)
         return y;
     if (!y)
         return x;
-    object::id type = x->type();
-    size_t sx = 0, sy = 0;
-    utf8 tx = x->value(&sx);
-    utf8 ty = y->value(&sy);
-    text_g concat = rt.make<text>(type, tx, sx + sy);
-    if (concat)
-    {
-        utf8 tc = concat->value();
-        memcpy((byte *) tc + sx, (byte *) ty, sy);
-    }
-    return concat;
+    size_t  sy = 0;
+    gcbytes ty = y->value(&sy);
+    return text::append(x, ty, sy);
 }
 
 
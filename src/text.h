@@ -123,6 +123,11 @@ struct text : algebraic
         return (utf8) p;
     }
 
+    static text_g append(text_r x, gcbytes data, size_t len);
+    // ------------------------------------------------------------------------
+    //   Append bytes to a text or list, growing it in place if possible
+    // ------------------------------------------------------------------------
+
     size_t utf8_characters() const;
     text_p import() const;      // Import text containing << or >> or ->
 
@@ -96,6 +96,10 @@ user_interface::user_interface()
       topics(),
       image(nullptr),
       impos(0),
+      help_layout(-1u),
+      help_lines_count(0),
+      help_fonts(0),
+      help_lines(),
       cursor(0),
       select(~0U),
       searching(~0U),
@@ -147,6 +151,8 @@ user_interface::user_interface()
       adjustSeps(false),
       graphics(false),
       dbl_release(false),
+      keymapResolved(false),
+      userKeysResolved(false),
       keymap(),
       helpfile()
 {
@@ -668,25 +674,48 @@ object_p user_interface::assign(int keyid, object_p toassign)
 
 object_p user_interface::assigned(int keyid)
 // ----------------------------------------------------------------------------
-//   Assign an object to a given key
+//   Return the object assigned to a given key
 // ----------------------------------------------------------------------------
+//   Bindings live in the globals, which only move when variables change.
+//   The last binding looked up for each key position is cached, and the
+//   cache is invalidated by directory::store, directory::purge and when
+//   the current directory changes.
 {
-    object_p name = object::static_object(object::ID_KeyMap);
-    directory *dir = nullptr;
-    for (uint depth = 0; (dir = rt.variables(depth)); depth++)
+    if (!userKeysResolved)
+    {
+        for (uint k = 0; k < NUM_KEYS; k++)
+            user_keyid[k] = 0;
+        userKeysResolved = true;
+    }
+    uint slot = uint(keyid) % NUM_KEYS;
+    if (user_keyid[slot] == keyid)
+        return user_key[slot];
+
+    object_p   result = nullptr;
+    object_p   name   = object::static_object(object::ID_KeyMap);
+    directory *dir    = nullptr;
+    for (uint depth = 0; !result && (dir = rt.variables(depth)); depth++)
     {
         if (object_p keymapvar = dir->recall(name))
         {
-            if (directory_p keymap = keymapvar->as<directory>())
+            if (directory_g keymap = keymapvar->as<directory>())
             {
                 integer_p keyname = integer::make(keyid);
                 settings::SaveNumberedVariables sn(true);
-                if (object_p binding = keymap->recall(keyname))
-                    return binding;
+                if (!keyname)
+                    return nullptr;
+                result = keymap->recall(keyname);
             }
         }
     }
-    return nullptr;
+
+    // Allocating the key name may have run the GC, but not moved globals
+    if (userKeysResolved)
+    {
+        user_key[slot] = result;
+        user_keyid[slot] = keyid;
+    }
+    return result;
 }
 
 
@@ -3274,9 +3303,40 @@ restart:
     bool    hadTitle  = false;
     static char link[60];
 
+    // The layout of the lines is only valid for a given topic and fonts
+    uintptr_t fonts = 0;
+    for (uint s = 0; s < NUM_STYLES; s++)
+        fonts = fonts * 31 + uintptr_t(styles[s].font);
+    if (help_layout != help || help_fonts != fonts)
+    {
+        help_layout      = help;
+        help_fonts       = fonts;
+        help_lines_count = 0;
+    }
+
     // Pun not indented
     helpfile.seek(help);
 
+    // Resume from the last line known to be above the visible area
+    for (uint l = help_lines_count; l-- > 0; )
+    {
+        const help_line &hl = help_lines[l];
+        if (hl.ypos + 2 < line)
+        {
+            helpfile.seek(hl.offset);
+            y         = ytop + 2 - line + hl.ypos;
+            x         = hl.x;
+            xleft     = hl.xleft;
+            style     = style_name(hl.style);
+            font      = styles[hl.fontStyle].font;
+            height    = font->height();
+            lastTopic = hl.lastTopic;
+            codeStart = hl.codeStart;
+            hadTitle  = hl.hadTitle;
+            break;
+        }
+    }
+
     // Display until end of help
     while (y < ybot)
     {
@@ -3294,10 +3354,41 @@ restart:
             {
                 shown  = helpfile.position();
             }
-            else if (last == '\n' && line > 0 && y < ytop - 2*LCD_H)
+            else if (last == '\n' && line > 0 && y < ytop - 2*LCD_H &&
+                     help_lines_count >= NUM_HELP_LINES)
             {
-                help = helpfile.position();
-                line = ytop + 2 - y;
+                // Layout is full, restart it from here
+                help             = helpfile.position();
+                line             = ytop + 2 - y;
+                help_layout      = help;
+                help_lines_count = 0;
+            }
+        }
+
+        // Remember where lines begin, about every half screen
+        if (last == '\n' && help_lines_count < NUM_HELP_LINES)
+        {
+            uint ypos   = y - (ytop + 2 - coord(line));
+            uint offset = helpfile.position();
+            help_line *prev = help_lines_count
+                ? &help_lines[help_lines_count - 1]
+                : nullptr;
+            if (!prev ||
+                (offset > prev->offset && ypos >= prev->ypos + LCD_H / 2))
+            {
+                uint fstyle = 0;
+                while (fstyle < NUM_STYLES - 1 && styles[fstyle].font != font)
+                    fstyle++;
+                help_line &hl = help_lines[help_lines_count++];
+                hl.offset     = offset;
+                hl.ypos       = ypos;
+                hl.lastTopic  = lastTopic;
+                hl.codeStart  = codeStart;
+                hl.x          = x;
+                hl.xleft      = xleft;
+                hl.style      = style;
+                hl.fontStyle  = fstyle;
+                hl.hadTitle   = hadTitle;
             }
         }
 
@@ -4388,9 +4479,8 @@ bool user_interface::handle_editing(int key)
             if (xshift)
             {
                 // Sort by value
-                typedef int (*qsort_fn)(const void *, const void*);
-                qsort(rt.stack_base(), interactive,
-                      sizeof(object_p), qsort_fn(value_compare));
+                if (!sort_stack(interactive, value_compare))
+                    beep(2400, 100);
             }
             else if (shift)
             {
@@ -4410,9 +4500,8 @@ bool user_interface::handle_editing(int key)
             if (xshift)
             {
                 // Sort by memory representation
-                typedef int (*qsort_fn)(const void *, const void*);
-                qsort(rt.stack_base(), interactive,
-                      sizeof(object_p), qsort_fn(memory_compare));
+                if (!sort_stack(interactive, memory_compare))
+                    beep(2400, 100);
             }
             else if (shift)
             {
@@ -5373,6 +5462,7 @@ bool user_interface::load_keymap(cstring name)
     if (result)
     {
         keymap = result;
+        keymapResolved = false;
 #if SIMULATOR
         ui_load_keymap(name);
 #endif // SIMULATOR
@@ -5398,10 +5488,22 @@ object_p user_interface::object_for_key(int key)
     }
 
     if (keymap && key > 0 && key <= NUM_KEYS)
-        if (object_p planeobj = keymap->at(plane + NUM_PLANES * alpha_plane()))
+    {
+        uint kplane = plane + NUM_PLANES * alpha_plane();
+        if (!keymapResolved)
+            resolve_keymap();
+        if (keymapResolved)
+        {
+            if (uint16_t offset = keymap_offset[kplane][key - 1])
+                return object_p(byte_p(keymap) + offset);
+        }
+        else if (object_p planeobj = keymap->at(kplane))
+        {
             if (list_p plane = planeobj->as_array_or_list())
                 if (object_p keyobj = plane->at(key-1))
                     return keyobj;
+        }
+    }
 
     const byte *ptr = defaultCommand[plane] + 2 * (key - 1);
     if (*ptr)
@@ -5410,6 +5512,41 @@ object_p user_interface::object_for_key(int key)
 }
 
 
+void user_interface::resolve_keymap()
+// ----------------------------------------------------------------------------
+//   Record where the object for each plane and key is in the keymap
+// ----------------------------------------------------------------------------
+//   Offsets are relative to keymap, which runtime::move already adjusts,
+//   so the table remains valid across garbage collection.
+//   Keymaps too large for 16-bit offsets are walked on each key press.
+{
+    for (uint p = 0; p < NUM_KEYMAP_PLANES; p++)
+        for (uint k = 0; k < NUM_KEYS; k++)
+            keymap_offset[p][k] = 0;
+    if (!keymap || keymap->size() > UINT16_MAX)
+        return;
+
+    uint p = 0;
+    for (object_p planeobj : *keymap)
+    {
+        if (p >= NUM_KEYMAP_PLANES)
+            break;
+        if (list_p plane = planeobj->as_array_or_list())
+        {
+            uint k = 0;
+            for (object_p keyobj : *plane)
+            {
+                if (k >= NUM_KEYS)
+                    break;
+                keymap_offset[p][k++] = byte_p(keyobj) - byte_p(keymap);
+            }
+        }
+        p++;
+    }
+    keymapResolved = true;
+}
+
+
 bool user_interface::handle_functions(int key)
 // ----------------------------------------------------------------------------
 //   Check if we have one of the soft menu functions
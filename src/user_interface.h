@@ -80,6 +80,8 @@ struct user_interface
         NUM_KEYS        = 46,   // Including SCREENSHOT, SH_UP and SH_DN
         NUM_SOFTKEYS    = 6,    // Number of softkeys
         NUM_MENUS = NUM_PLANES * NUM_SOFTKEYS,
+        NUM_KEYMAP_PLANES = NUM_PLANES * 3, // Shift planes for each alpha plane
+        NUM_HELP_LINES  = 32,   // Lines remembered in the help layout
     };
 
     using result = object::result;
@@ -177,6 +179,7 @@ struct user_interface
     void        clear_help();
     void        clear_menu();
     object_p    object_for_key(int key);
+    void        user_keys_changed() { userKeysResolved = false; }
     int         evaluating_function_key() const;
     bool        end_edit();
     void        clear_editor();
@@ -229,6 +232,7 @@ struct user_interface
     void        load_help(utf8 topic, size_t len = 0);
 
     bool        load_keymap(cstring filename);
+    void        resolve_keymap();
 
 protected:
     bool        handle_screen_capture(int key);
@@ -245,6 +249,23 @@ protected:
     bool        do_search(unicode with = 0, bool restart = false);
 
 
+    struct help_line
+    // ------------------------------------------------------------------------
+    //   State of the help renderer at the beginning of a line
+    // ------------------------------------------------------------------------
+    {
+        uint     offset;        // Position in the help file
+        uint     ypos;          // Vertical position from start of topic
+        uint     lastTopic;     // Last link seen before that line
+        uint     codeStart;     // Start of the last RPL code block
+        coord    x;             // Horizontal position
+        coord    xleft;         // Left margin, e.g. for bullet lists
+        uint8_t  style;         // Style for the next word
+        uint8_t  fontStyle;     // Style giving the font of previous word
+        bool     hadTitle;      // Previous word was a title
+    };
+
+
 public:
     int      evaluating;        // Key being evaluated
 
@@ -257,6 +278,10 @@ protected:
     uint     topics[8];         // Topics history
     grob_g   image;             // Image loaded in help file
     uint     impos;             // Position of image file
+    uint     help_layout;       // Offset of help for help_lines
+    uint     help_lines_count;  // Number of entries in help_lines
+    uintptr_t help_fonts;       // Fonts used for help_lines
+    help_line help_lines[NUM_HELP_LINES]; // Where help lines begin
     uint     cursor;            // Cursor position in buffer
     uint     select;            // Cursor position for selection marker
     uint     searching;         // Searching start point
@@ -316,10 +341,15 @@ protected:
     bool     freezeStack  : 1;  // Freeze the stack area
     bool     freezeMenu   : 1;  // Freeze the menu area
     bool     dbl_release  : 1;  // Double release
+    bool     keymapResolved : 1;  // keymap_offset matches keymap
+    bool     userKeysResolved : 1; // user_key entries are valid
 
 protected:
     // Key mappings
     list_p   keymap;
+    uint16_t keymap_offset[NUM_KEYMAP_PLANES][NUM_KEYS];
+    object_p user_key[NUM_KEYS];
+    uint16_t user_keyid[NUM_KEYS];
     object_p function[NUM_PLANES][NUM_SOFTKEYS];
     cstring  menu_label[NUM_PLANES][NUM_SOFTKEYS];
     uint16_t menu_marker[NUM_PLANES][NUM_SOFTKEYS];
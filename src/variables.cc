@@ -40,6 +40,7 @@
 #include "parser.h"
 #include "renderer.h"
 #include "tag.h"
+#include "user_interface.h"
 
 RECORDER(directory,       16, "Directories");
 RECORDER(directory_error, 16, "Errors from directories");
@@ -202,6 +203,7 @@ object_p directory::store(object_g name, object_g value)
     size_t      vs      = value->size();        // Size of value
     int         delta   = 0;                    // Change in directory size
     directory_g thisdir = this;                 // Can move because of GC
+    ui.user_keys_changed();                     // Key bindings may move
 
     // If this is a quoted name, extract it
     if (object_p quoted = name->as_quoted(ID_object))
@@ -540,6 +542,7 @@ size_t directory::purge(object_p name)
 // ----------------------------------------------------------------------------
 {
     directory_g thisdir = this;
+    ui.user_keys_changed();                     // Key bindings may move
 
     // Deal with all special cases
     id nty = name->type();